@@ -0,0 +1,255 @@
+//
+// Paged driver for 24xx series I2C EEPROMs (24C02 ... 24C512, 24CM01/02)
+//
+
+#include "eeprom24xx.h"
+
+static void EEPROM24_StartNext(EEPROM24_Obj *obj);
+
+/**
+  * @brief Device address for a memory address, bits above the sub-address select the block
+  */
+static uint8_t EEPROM24_DevAddress(const EEPROM24_Obj *obj, uint32_t address) {
+    return (uint8_t)(obj->SAD | ((address >> (8 * obj->config.addressSize)) & 0x7));
+}
+
+static StatusTypeDef EEPROM24_Status(uint8_t error) {
+    switch (error) {
+        case I2C_ERRROR_NONE:
+            return STATUS_OK;
+        case I2C_ERROR_TIMEOUT:
+            return STATUS_TIMEOUT;
+        default:
+            return STATUS_ERROR;
+    }
+}
+
+/**
+  * @brief Completes the write request at the queue tail and starts the next one
+  */
+static void EEPROM24_FinishWrite(EEPROM24_Obj *obj, StatusTypeDef status) {
+    EEPROM24_RequestTypeDef request = obj->queue[obj->queueTail & (EEPROM24_QUEUE_SIZE - 1)];
+
+    obj->queueTail++;
+    obj->state = EEPROM24_IDLE;
+
+    // The callback may queue more writes, they start below
+    if (request.done) {
+        request.done(obj, status, request.context);
+    }
+    if (obj->state == EEPROM24_IDLE) {
+        EEPROM24_StartNext(obj);
+    }
+}
+
+static void EEPROM24_FinishRead(EEPROM24_Obj *obj, StatusTypeDef status) {
+    obj->state = EEPROM24_IDLE;
+    if (obj->read.done) {
+        obj->read.done(obj, status, obj->read.context);
+    }
+    if (obj->state == EEPROM24_IDLE) {
+        EEPROM24_StartNext(obj);
+    }
+}
+
+/**
+  * @brief Writes the next page aligned burst of the current request
+  */
+static void EEPROM24_StartBurst(EEPROM24_Obj *obj) {
+    EEPROM24_RequestTypeDef *request = &obj->queue[obj->queueTail & (EEPROM24_QUEUE_SIZE - 1)];
+    uint32_t address = request->address + obj->written;
+    uint32_t pageLeft = obj->config.pageSize - (address % obj->config.pageSize);
+    uint32_t left = (uint32_t)request->size - obj->written;
+
+    obj->burst = (uint16_t)(left < pageLeft ? left : pageLeft);
+    obj->state = EEPROM24_WRITING;
+    obj->pending = 0;
+    obj->inFlight = 1;
+
+    StatusTypeDef status = I2Cx_MemWrite_IT(obj->bus, EEPROM24_DevAddress(obj, address), (uint16_t)address,
+                                            obj->config.addressSize, request->data + obj->written, obj->burst);
+    if (status == STATUS_BUSY) {
+        // Someone else holds the bus, EEPROM24_Process retries the burst
+        obj->inFlight = 0;
+    } else if (status != STATUS_OK) {
+        obj->inFlight = 0;
+        EEPROM24_FinishWrite(obj, status);
+    }
+}
+
+static void EEPROM24_StartNext(EEPROM24_Obj *obj) {
+    if (obj->queueHead != obj->queueTail) {
+        obj->written = 0;
+        EEPROM24_StartBurst(obj);
+    }
+}
+
+/**
+  * @brief Probes the device with an empty write, it NACKs until the internal write cycle is done
+  */
+static void EEPROM24_Probe(EEPROM24_Obj *obj) {
+    EEPROM24_RequestTypeDef *request = &obj->queue[obj->queueTail & (EEPROM24_QUEUE_SIZE - 1)];
+
+    obj->pending = 0;
+    obj->inFlight = 1;
+    StatusTypeDef status = I2Cx_Write_IT(obj->bus, EEPROM24_DevAddress(obj, request->address), 0, 0);
+    if (status == STATUS_BUSY) {
+        // Someone else holds the bus, try again on the next call
+        obj->inFlight = 0;
+    } else if (status != STATUS_OK) {
+        obj->inFlight = 0;
+        EEPROM24_FinishWrite(obj, status);
+    }
+}
+
+/**
+  * @retval STATUS_ERROR if the handle can't send the part's sub-address, 2 byte parts need I2C_CONF_MEM_ADDRESS_16BIT
+  */
+StatusTypeDef EEPROM24_Init(EEPROM24_Obj *obj, I2C_HandleTypeDef *bus, uint8_t SAD, const EEPROM24_ConfigTypeDef *config) {
+    if (config->addressSize == 0 || config->addressSize > sizeof(I2C_MemAddressTypeDef)) {
+        return STATUS_ERROR;
+    }
+
+    obj->bus = bus;
+    obj->SAD = SAD;
+    obj->config = *config;
+    obj->state = EEPROM24_IDLE;
+    obj->queueHead = 0;
+    obj->queueTail = 0;
+    obj->written = 0;
+    obj->burst = 0;
+    obj->inFlight = 0;
+    obj->pending = 0;
+    obj->result = I2C_ERRROR_NONE;
+    return STATUS_OK;
+}
+
+/**
+  * @brief Queues a write of any length and alignment, EEPROM24_Process starts it and calls done once it is committed
+  * @param data: Must stay valid until done is called
+  * @retval STATUS_BUSY if the queue is full, STATUS_ERROR if the range does not fit the device
+  */
+StatusTypeDef EEPROM24_WriteAsync(EEPROM24_Obj *obj, uint32_t address, uint8_t *data, uint16_t size, EEPROM24_DoneCallBack done, void *context) {
+    if (size == 0 || address + size > obj->config.capacity) {
+        return STATUS_ERROR;
+    }
+    if ((uint8_t)(obj->queueHead - obj->queueTail) == EEPROM24_QUEUE_SIZE) {
+        return STATUS_BUSY;
+    }
+
+    EEPROM24_RequestTypeDef *request = &obj->queue[obj->queueHead & (EEPROM24_QUEUE_SIZE - 1)];
+    request->address = address;
+    request->data = data;
+    request->size = size;
+    request->done = done;
+    request->context = context;
+    obj->queueHead++;
+    return STATUS_OK;
+}
+
+/**
+  * @brief Reads size bytes starting at address as one sequential read
+  * @retval STATUS_BUSY while a write or read is queued or in progress
+  */
+StatusTypeDef EEPROM24_Read_IT(EEPROM24_Obj *obj, uint32_t address, uint8_t *data, uint16_t size, EEPROM24_DoneCallBack done, void *context) {
+    if (size == 0 || address + size > obj->config.capacity) {
+        return STATUS_ERROR;
+    }
+    if (!EEPROM24_Idle(obj)) {
+        return STATUS_BUSY;
+    }
+
+    obj->read.address = address;
+    obj->read.data = data;
+    obj->read.size = size;
+    obj->read.done = done;
+    obj->read.context = context;
+    obj->state = EEPROM24_READING;
+    obj->pending = 0;
+    obj->inFlight = 1;
+
+    StatusTypeDef status = I2Cx_MemRead_IT(obj->bus, EEPROM24_DevAddress(obj, address), (uint16_t)address,
+                                           obj->config.addressSize, data, size);
+    if (status != STATUS_OK) {
+        obj->inFlight = 0;
+        obj->state = EEPROM24_IDLE;
+    }
+    return status;
+}
+
+/**
+  * @brief Advances the driver, call it until EEPROM24_Idle returns 1
+  */
+void EEPROM24_Process(EEPROM24_Obj *obj) {
+    if (obj->inFlight) {
+        if (!obj->pending) {
+            return;
+        }
+        obj->inFlight = 0;
+        obj->pending = 0;
+
+        uint8_t error = obj->result;
+        switch (obj->state) {
+            case EEPROM24_WRITING:
+            {
+                if (error != I2C_ERRROR_NONE) {
+                    EEPROM24_FinishWrite(obj, EEPROM24_Status(error));
+                    return;
+                }
+                obj->written += obj->burst;
+                obj->state = EEPROM24_ACK_POLLING;
+                I2C_Deadline_Start(&obj->pollDeadline, obj->config.writeCycleTimeoutUs);
+                break;
+            }
+            case EEPROM24_ACK_POLLING:
+            {
+                if (error == I2C_ERRROR_NONE) {
+                    // Write cycle done
+                    if (obj->written == obj->queue[obj->queueTail & (EEPROM24_QUEUE_SIZE - 1)].size) {
+                        EEPROM24_FinishWrite(obj, STATUS_OK);
+                    } else {
+                        EEPROM24_StartBurst(obj);
+                    }
+                    return;
+                }
+                if (error != I2C_ERROR_NACK) {
+                    EEPROM24_FinishWrite(obj, EEPROM24_Status(error));
+                    return;
+                }
+                break;
+            }
+            case EEPROM24_READING:
+            {
+                EEPROM24_FinishRead(obj, EEPROM24_Status(error));
+                return;
+            }
+            default:
+                return;
+        }
+    }
+
+    if (obj->state == EEPROM24_IDLE) {
+        EEPROM24_StartNext(obj);
+    } else if (obj->state == EEPROM24_WRITING) {
+        // The burst was refused with the bus busy
+        EEPROM24_StartBurst(obj);
+    } else if (obj->state == EEPROM24_ACK_POLLING) {
+        if (I2C_Deadline_Expired(&obj->pollDeadline)) {
+            EEPROM24_FinishWrite(obj, STATUS_TIMEOUT);
+        } else {
+            EEPROM24_Probe(obj);
+        }
+    }
+}
+
+uint8_t EEPROM24_Idle(const EEPROM24_Obj *obj) {
+    return obj->state == EEPROM24_IDLE && obj->queueHead == obj->queueTail;
+}
+
+/**
+  * @brief Records the result of the bus transfer, call from the I2C completion and timeout callbacks
+  */
+void EEPROM24_Cplt_Callback(EEPROM24_Obj *obj) {
+    obj->result = obj->bus->error;
+    obj->pending = 1;
+}
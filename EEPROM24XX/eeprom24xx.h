@@ -0,0 +1,96 @@
+//
+// Paged driver for 24xx series I2C EEPROMs (24C02 ... 24C512, 24CM01/02)
+//
+
+#ifndef HOMEMONITOR_EEPROM24XX_H
+#define HOMEMONITOR_EEPROM24XX_H
+
+#include <stdint.h>
+#include "commons.h"
+#include "i2c.h"
+
+// IMPORTANT
+// Needs I2C_CONF_IT, I2C_CONF_MEM and I2C_CONF_CALLBACKS and a clock source for the write cycle deadline (i2c_clock.h)
+// Route the bus WriteCplt, MemTxCplt and MemRxCplt callbacks and the I2Cx_SetTimeoutCallBack callback to EEPROM24_Cplt_Callback while the EEPROM owns the bus
+// Call EEPROM24_Process from the main loop or a task, queued writes start and the completion callbacks of requests run from there
+// 2 byte address parts (24C32 and up) need I2C_CONF_MEM_ADDRESS_16BIT, EEPROM24_Init refuses them otherwise
+// EEPROM24_WriteAsync, EEPROM24_Read_IT and EEPROM24_Process must all be called from the same context
+/* Writes are split into page aligned bursts, each burst is one MemWrite transaction. After a burst
+ * the device is ACK polled with empty writes until it answers again, instead of waiting out the
+ * worst case write cycle time. Reads are streamed as one sequential read of any length.
+ */
+
+#if !I2C_CONF_IT || !I2C_CONF_MEM || !I2C_CONF_CALLBACKS
+#error "eeprom24xx needs I2C_CONF_IT, I2C_CONF_MEM and I2C_CONF_CALLBACKS"
+#endif
+
+#define EEPROM24_SAD           0x50
+
+#ifndef EEPROM24_QUEUE_SIZE
+#define EEPROM24_QUEUE_SIZE    4    // Pending write requests, power of two
+#endif
+
+#if (EEPROM24_QUEUE_SIZE & (EEPROM24_QUEUE_SIZE - 1)) != 0
+#error "EEPROM24_QUEUE_SIZE must be a power of two"
+#endif
+
+// Part presets: page size, capacity, address bytes, write cycle timeout in us
+#define EEPROM24_CONFIG_24C02  { 8,   256,    1, 10000 }
+#define EEPROM24_CONFIG_24C16  { 16,  2048,   1, 10000 }
+#define EEPROM24_CONFIG_24C64  { 32,  8192,   2, 10000 }
+#define EEPROM24_CONFIG_24C256 { 64,  32768,  2, 10000 }
+#define EEPROM24_CONFIG_24C512 { 128, 65536,  2, 10000 }
+#define EEPROM24_CONFIG_24CM02 { 256, 262144, 2, 10000 }
+
+typedef struct {
+    uint16_t pageSize;
+    uint32_t capacity;
+    uint8_t addressSize;            // Sub-address bytes, higher address bits go to the device address
+    uint32_t writeCycleTimeoutUs;   // How long ACK polling may take after one page write
+} EEPROM24_ConfigTypeDef;
+
+typedef enum {
+    EEPROM24_IDLE        = 0x0,
+    EEPROM24_WRITING     = 0x1,
+    EEPROM24_ACK_POLLING = 0x2,
+    EEPROM24_READING     = 0x3
+} EEPROM24_StateTypeDef;
+
+typedef struct EEPROM24_ObjStruct EEPROM24_Obj;
+
+typedef void (*EEPROM24_DoneCallBack)(EEPROM24_Obj *obj, StatusTypeDef status, void *context);
+
+typedef struct {
+    uint32_t address;
+    uint8_t *data;
+    uint16_t size;
+    EEPROM24_DoneCallBack done;
+    void *context;
+} EEPROM24_RequestTypeDef;
+
+struct EEPROM24_ObjStruct {
+    I2C_HandleTypeDef *bus;
+    uint8_t SAD;
+    EEPROM24_ConfigTypeDef config;
+    EEPROM24_StateTypeDef state;
+    EEPROM24_RequestTypeDef read;
+    EEPROM24_RequestTypeDef queue[EEPROM24_QUEUE_SIZE];
+    uint8_t queueHead;
+    uint8_t queueTail;
+    uint16_t written;               // Bytes of the current write request already committed
+    uint16_t burst;                 // Bytes in the page write on the bus
+    I2C_DeadlineTypeDef pollDeadline;
+    uint8_t inFlight;
+    volatile uint8_t pending;       // Set from interrupt context when the bus transfer completed
+    volatile uint8_t result;        // I2C_ErrorTypeDef of the completed transfer
+};
+
+StatusTypeDef EEPROM24_Init(EEPROM24_Obj *obj, I2C_HandleTypeDef *bus, uint8_t SAD, const EEPROM24_ConfigTypeDef *config);
+StatusTypeDef EEPROM24_WriteAsync(EEPROM24_Obj *obj, uint32_t address, uint8_t *data, uint16_t size, EEPROM24_DoneCallBack done, void *context);
+StatusTypeDef EEPROM24_Read_IT(EEPROM24_Obj *obj, uint32_t address, uint8_t *data, uint16_t size, EEPROM24_DoneCallBack done, void *context);
+void EEPROM24_Process(EEPROM24_Obj *obj);
+uint8_t EEPROM24_Idle(const EEPROM24_Obj *obj);
+
+void EEPROM24_Cplt_Callback(EEPROM24_Obj *obj);
+
+#endif //HOMEMONITOR_EEPROM24XX_H
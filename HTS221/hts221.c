@@ -50,7 +50,7 @@ void HTS221_Write_Reg_Cplt_Callback(HTS221_Obj *obj) {
     }
 }
 
-void HTS221_Init(HTS221_Obj *obj, Peripheral_IO_Object *io) {
+void HTS221_Init(HTS221_Obj *obj, HTS221_IO_Object *io) {
     obj->state = HTS221_INITIALIZING;
     obj->SAD = HTS221_SAD;
     obj->IO = io;
@@ -49,7 +49,7 @@ typedef enum {
     HTS221_AVGH128 = 0x5,
     HTS221_AVGH256 = 0x6,
     HTS221_AVGH512 = 0x7
-} HTS221_AVGTTypeDef;
+} HTS221_AVGHTypeDef;
 
 typedef enum {
     BDU_continuous = 0x0,
@@ -63,7 +63,7 @@ typedef enum {
     HTS221_12HZ   = 0x3
 } HTS221_ODRTypeDef;
 
-typedef struct {
+typedef enum {
     HTS221_DRDY_DISABLED = 0x0,
     HTS221_DRDY_ENABLED = 0x1,
 } HTS221_DRDYTypeDef;
@@ -99,7 +99,7 @@ typedef struct {
     int16_t T1_out;
     uint16_t H0_rH;
     uint16_t H1_rH;
-    int16_T H0_out;
+    int16_t H0_out;
     int16_t H1_out;
 } HTS221_CalibrationValuesTypeDef;
 
@@ -116,13 +116,13 @@ typedef struct {
     HTS221_StateTypeDef state;
     HTS221_SettingsTypeDef settings;
     HTS221_RegisterTypeDef registers;
-    Peripheral_IO_Object *IO;
+    HTS221_IO_Object *IO;
     HTS221_CalibrationValuesTypeDef calibrations;
     int16_t temperature;
     uint16_t humidity;
 } HTS221_Obj;
 
-void HTS221_Init(HTS221_Obj *obj, Peripheral_IO_Object *io);
+void HTS221_Init(HTS221_Obj *obj, HTS221_IO_Object *io);
 void HTS221_SetPowered(HTS221_Obj *obj, HTS221_PoweredTypeDef powered);
 void HTS221_SetResolution(HTS221_Obj *obj, HTS221_AVGTTypeDef tempRes, HTS221_AVGHTypeDef humRes);
 void HTS221_SetBDU(HTS221_Obj *obj, HTS221_BDUTypeDef bdu);
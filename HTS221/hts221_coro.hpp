@@ -0,0 +1,92 @@
+//
+// Coroutine based HTS221 acquisition on top of i2c_coro.hpp
+//
+
+#ifndef HOMEMONITOR_HTS221_CORO_HPP
+#define HOMEMONITOR_HTS221_CORO_HPP
+
+#include "i2c_coro.hpp"
+
+extern "C" {
+#include "hts221.h"
+}
+
+// Spawn hts221::Acquire(bus, obj) whenever a new reading is wanted, obj is updated when the Task finishes
+// The returned Task is false if the frame pool was exhausted and nothing was started
+
+namespace hts221 {
+
+// MSB of the sub-address enables register auto-increment for multi-byte reads
+constexpr uint8_t AUTO_INCREMENT  = 0x80;
+constexpr uint8_t CTRL_REG1_PD    = 0x80;
+constexpr uint8_t CTRL_REG2_ONE_SHOT = 0x01;
+constexpr uint8_t STATUS_H_DA_T_DA = 0x03;
+constexpr uint8_t MAX_STATUS_POLLS = 255;
+
+inline void DecodeCalibration(HTS221_Obj &obj) {
+    const uint8_t *calib = obj.registers.CALIB_0TOF;
+
+    obj.calibrations.H0_rH = calib[0] / 2;
+    obj.calibrations.H1_rH = calib[1] / 2;
+    obj.calibrations.T0_degC = (int16_t)((calib[2] | ((calib[5] & 0x3) << 8)) >> 3);
+    obj.calibrations.T1_degC = (int16_t)((calib[3] | (((calib[5] >> 2) & 0x3) << 8)) >> 3);
+    obj.calibrations.H0_out = (int16_t)(calib[6] | (calib[7] << 8));
+    obj.calibrations.H1_out = (int16_t)(calib[10] | (calib[11] << 8));
+    obj.calibrations.T0_out = (int16_t)(calib[12] | (calib[13] << 8));
+    obj.calibrations.T1_out = (int16_t)(calib[14] | (calib[15] << 8));
+}
+
+inline void DecodeReading(HTS221_Obj &obj) {
+    const HTS221_CalibrationValuesTypeDef &c = obj.calibrations;
+    int32_t rawH = (int16_t)(obj.registers.HUMIDITY_OUT_L | (obj.registers.HUMIDITY_OUT_H << 8));
+    int32_t rawT = (int16_t)(obj.registers.TEMP_OUT_L | (obj.registers.TEMP_OUT_H << 8));
+
+    obj.humidity = (uint16_t)(((int32_t)(c.H1_rH - c.H0_rH) * (rawH - c.H0_out)) / (c.H1_out - c.H0_out) + c.H0_rH);
+    obj.temperature = (int16_t)(((int32_t)(c.T1_degC - c.T0_degC) * (rawT - c.T0_out)) / (c.T1_out - c.T0_out) + c.T0_degC);
+}
+
+/**
+  * @brief Reads calibration once, then powers the sensor, triggers a one-shot conversion and reads it back
+  */
+inline i2c::Task Acquire(i2c::Bus &bus, HTS221_Obj &obj) {
+    uint8_t reg;
+
+    if (obj.state == HTS221_INITIALIZING) {
+        if (co_await bus.memRead(obj.SAD, HTS221_CALIB_0TOF | AUTO_INCREMENT, obj.registers.CALIB_0TOF) != STATUS_OK) {
+            co_return;
+        }
+        DecodeCalibration(obj);
+    }
+
+    obj.state = HTS221_CONFIGURING;
+    reg = CTRL_REG1_PD;
+    if (co_await bus.memWrite(obj.SAD, HTS221_CTRL_REG1, std::span<uint8_t>(&reg, 1)) != STATUS_OK) {
+        co_return;
+    }
+
+    obj.state = HTS221_REQUESTING;
+    reg = CTRL_REG2_ONE_SHOT;
+    if (co_await bus.memWrite(obj.SAD, HTS221_CTRL_REG2, std::span<uint8_t>(&reg, 1)) != STATUS_OK) {
+        co_return;
+    }
+
+    // Each poll is an I2C read, so the coroutine stays suspended in between
+    reg = 0;
+    for (uint8_t polls = 0; (reg & STATUS_H_DA_T_DA) != STATUS_H_DA_T_DA; polls++) {
+        if (polls == MAX_STATUS_POLLS || co_await bus.memRead(obj.SAD, HTS221_STATUS_REG, std::span<uint8_t>(&reg, 1)) != STATUS_OK) {
+            co_return;
+        }
+    }
+
+    obj.state = HTS221_READING;
+    if (co_await bus.memRead(obj.SAD, HTS221_HUMIDITY_OUT_LR | AUTO_INCREMENT, std::span<uint8_t>(&obj.registers.HUMIDITY_OUT_L, 4)) != STATUS_OK) {
+        co_return;
+    }
+    DecodeReading(obj);
+    obj.state = HTS221_READY;
+}
+
+} // namespace hts221
+
+
+#endif //HOMEMONITOR_HTS221_CORO_HPP
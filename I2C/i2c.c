@@ -1,58 +1,220 @@
 #include "i2c.h"
+#include "i2c_trace.h"
 #include "stdint.h"
 
+#if I2C_CONF_CALLBACKS
+#define I2C_CALLBACK(handle, id, callBack)   do { if ((handle)->callBacksEnabled & (1U << (id))) { I2C_TRACE((handle)->instance, I2C_TRACE_CALLBACK, (id), 0); (handle)->callBacks->callBack(handle); } } while (0)
+#else
+#define I2C_CALLBACK(handle, id, callBack)   do { } while (0)
+#endif
+
+#if I2C_CONF_STATS
+#define I2C_STATS_INC(handle, counter)       ((handle)->stats.counter++)
+#else
+#define I2C_STATS_INC(handle, counter)       do { } while (0)
+#endif
+
 static void I2Cx_ChangeState(I2C_HandleTypeDef *handle, I2C_StateTypeDef newState);
+static void I2Cx_ResetHandle(I2C_HandleTypeDef *handle);
+static void I2Cx_Abort(I2C_HandleTypeDef *handle);
+static StatusTypeDef I2Cx_RejectBusy(I2C_HandleTypeDef *handle);
+#if I2C_CONF_IT
 static void I2Cx_PrepareHandle(I2C_HandleTypeDef *handle, I2C_OperationTypeDef operation, uint8_t devAddress, uint16_t memAddress, uint8_t memSize, uint8_t *data, uint16_t dataSize);
-static void I2Cx_ResetHandle(I2C_HandleTypeDef *handle, I2C_OperationTypeDef operation, uint8_t devAddress, uint16_t memAddress, uint8_t memSize, uint8_t *data, uint16_t dataSize);
-
-StatusTypeDef I2Cx_Init(I2C_HandleTypeDef *handle, I2C_TypeDef *instance) {
-    I2Cx_ResetHandle(handle);
+static void I2Cx_StartTransfer(I2C_HandleTypeDef *handle, uint32_t numBytes, uint32_t endMode, uint32_t startStopMode);
+#endif
+#if I2C_CONF_POLLING
+static StatusTypeDef I2Cx_WaitFlag(I2C_HandleTypeDef *handle, uint32_t flag, const I2C_DeadlineTypeDef *deadline);
+#endif
+
+void I2Cx_Init(I2C_HandleTypeDef *handle, I2C_TypeDef *instance) {
+    // ResetHandle traces against the instance, so it has to be set first
     handle->instance = instance;
+    I2Cx_ResetHandle(handle);
+#if I2C_CONF_IT
+    handle->timeoutUs = I2C_TIMEOUT_INFINITE;
+#endif
+#if I2C_CONF_CALLBACKS
+    handle->callBacks = NULL;
+    handle->callBacksEnabled = 0;
+#if I2C_CONF_IT
+    handle->timeoutCallBack = NULL;
+#endif
+#endif
+#if I2C_CONF_STATS
+    handle->stats.transfers = 0;
+    handle->stats.nacks = 0;
+    handle->stats.timeouts = 0;
+#endif
 }
 
 
-void I2Cx_AddCallBacks(I2C_HandleTypeDef *handle, I2C_CallBackHandle *callBacks, uint8_t callBacksEnabled[5]) {
+#if I2C_CONF_CALLBACKS
+void I2Cx_AddCallBacks(I2C_HandleTypeDef *handle, I2C_CallBackHandleTypeDef *callBacks, uint8_t callBacksEnabled[I2C_NUM_CALLBACKS]) {
     handle->callBacks = callBacks;
-    for (int i = 0; i < 5; i++) {
-        handle->callBacksEnabled[i] = callBacksEnabled[i];
+    handle->callBacksEnabled = 0;
+    for (int i = 0; i < I2C_NUM_CALLBACKS; i++) {
+        if (callBacksEnabled[i]) {
+            handle->callBacksEnabled |= (uint8_t)(1U << i);
+        }
     }
 }
+#endif
+
+#if I2C_CONF_IT && I2C_CONF_CALLBACKS
+/**
+  * @brief Sets the callback I2Cx_TimeoutTick runs after aborting a transfer, NULL disables it
+  */
+void I2Cx_SetTimeoutCallBack(I2C_HandleTypeDef *handle, I2C_TimeoutCallBackTypeDef callBack) {
+    handle->timeoutCallBack = callBack;
+}
+#endif
+
+#if I2C_CONF_IT
+/**
+  * @brief Sets the per-transaction timeout used by the interrupt driven functions
+  * @param timeoutUs: Microseconds from submission until I2Cx_TimeoutTick aborts the transfer, or I2C_TIMEOUT_INFINITE
+  */
+void I2Cx_SetTimeout(I2C_HandleTypeDef *handle, uint32_t timeoutUs) {
+    handle->timeoutUs = timeoutUs;
+}
+#endif
 
 /**
  * @brief Helper function to simplify recording the previous states
  */
 static void I2Cx_ChangeState(I2C_HandleTypeDef *handle, I2C_StateTypeDef newState) {
-	I2C_StateTypeDef tmp = handle->state;
+	I2C_TRACE(handle->instance, I2C_TRACE_STATE, newState, handle->state);
+#if I2C_CONF_PREVIOUS_STATE
+	handle->previousState = handle->state;
+#endif
 	handle->state = newState;
-	handle->previousState = tmp;
 }
 
+/**
+ * @brief Helper function for refused requests, a transfer in flight keeps its own error
+ */
+static StatusTypeDef I2Cx_RejectBusy(I2C_HandleTypeDef *handle) {
+    if (handle->state == I2C_READY) {
+      handle->error = I2C_ERROR_BUSY;
+    }
+    return STATUS_BUSY;
+}
+
+#if I2C_CONF_IT
 /**
  * @brief Helper function to prepare the TX handle
  */
 static void I2Cx_PrepareHandle(I2C_HandleTypeDef *handle, I2C_OperationTypeDef operation, uint8_t devAddress, uint16_t memAddress, uint8_t memSize, uint8_t *data, uint16_t dataSize) {
 	handle->devAddress = devAddress;
 	handle->operation = operation;
-	handle->memAddress = memAddress;
+#if I2C_CONF_MEM
+	handle->memAddress = (I2C_MemAddressTypeDef)memAddress;
 	handle->memSize = memSize;
+#else
+	(void)memAddress;
+	(void)memSize;
+#endif
 	handle->dataBuffer = data;
 	handle->dataSize = dataSize;
 	handle->error = I2C_ERRROR_NONE;
+	I2C_Deadline_Start(&handle->deadline, handle->timeoutUs);
+	I2C_TRACE(handle->instance, I2C_TRACE_SUBMIT, operation, dataSize);
+}
+
+/**
+  * @brief Issues START + address for a transfer of numBytes, longer transfers continue in 255 byte chunks via TCR reloads
+  */
+static void I2Cx_StartTransfer(I2C_HandleTypeDef *handle, uint32_t numBytes, uint32_t endMode, uint32_t startStopMode) {
+    if (numBytes > I2C_MAX_NBYTES) {
+      I2Cx_Send7BitAddress(handle->instance, handle->devAddress, I2C_MAX_NBYTES, I2C_Reload_Mode, startStopMode);
+    } else {
+      I2Cx_Send7BitAddress(handle->instance, handle->devAddress, (uint8_t)numBytes, endMode, startStopMode);
+    }
 }
+#endif
 
 static void I2Cx_ResetHandle(I2C_HandleTypeDef *handle) {
+    I2C_TRACE(handle->instance, I2C_TRACE_STATE, I2C_READY, handle->state);
     handle->operation = I2C_NONE;
-    handle->state = I2C_READY
+    handle->state = I2C_READY;
     handle->error = I2C_ERRROR_NONE;
     handle->devAddress = 0;
+#if I2C_CONF_MEM
     handle->memAddress = 0;
     handle->memSize = 0;
+    handle->memBytesSent = 0;
+#endif
     handle->dataBuffer = NULL;
     handle->dataSize = 0;
     handle->dataBytesTransmitted = 0;
-    handle->memBytesSent = 0;
 }
 
+/**
+  * @brief Stops a hung transfer and releases the bus
+  */
+static void I2Cx_Abort(I2C_HandleTypeDef *handle) {
+    I2C_TypeDef *instance = handle->instance;
+
+    instance->CR1 &= ~(I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE | I2C_CR1_TCIE);
+
+    // Software reset releases SCL/SDA and clears all flags, reading PE back covers the 3 APB cycle minimum
+    instance->CR1 &= ~I2C_CR1_PE;
+    while (instance->CR1 & I2C_CR1_PE) {
+    }
+    instance->CR1 |= I2C_CR1_PE;
+}
+
+#if I2C_CONF_POLLING
+/**
+  * @brief Releases the bus after a polling transaction ran past its deadline
+  */
+static StatusTypeDef I2Cx_PollTimeout(I2C_HandleTypeDef *handle, uint32_t flag) {
+    (void)flag;
+    I2C_TRACE(handle->instance, I2C_TRACE_TIMEOUT, handle->state, flag);
+    I2Cx_Abort(handle);
+    I2Cx_ResetHandle(handle);
+    handle->error = I2C_ERROR_TIMEOUT;
+    I2C_STATS_INC(handle, timeouts);
+    return STATUS_TIMEOUT;
+}
+
+/**
+  * @brief Polls an ISR flag until it sets, the device NACKs or the transaction deadline passes
+  * @retval STATUS_ERROR with I2C_ERROR_NACK once the automatic STOP after a NACK is done, STATUS_TIMEOUT on expiry
+  */
+static StatusTypeDef I2Cx_WaitFlag(I2C_HandleTypeDef *handle, uint32_t flag, const I2C_DeadlineTypeDef *deadline) {
+    I2C_TypeDef *instance = handle->instance;
+
+    while (!(instance->ISR & flag))
+    {
+      // After a NACK the peripheral only generates STOP, TXIS or RXNE never set
+      if (instance->ISR & I2C_ISR_NACKF)
+      {
+        instance->ICR = I2C_ICR_NACKCF;
+        I2C_TRACE(instance, I2C_TRACE_NACK, handle->state, 0);
+        while (!(instance->ISR & I2C_ISR_STOPF))
+        {
+          if (I2C_Deadline_Expired(deadline))
+          {
+            return I2Cx_PollTimeout(handle, I2C_ISR_STOPF);
+          }
+        }
+        instance->ICR = I2C_ICR_STOPCF;
+        I2C_TRACE(instance, I2C_TRACE_STOP, 0, 0);
+        I2Cx_ResetHandle(handle);
+        handle->error = I2C_ERROR_NACK;
+        I2C_STATS_INC(handle, nacks);
+        return STATUS_ERROR;
+      }
+      if (I2C_Deadline_Expired(deadline))
+      {
+        return I2Cx_PollTimeout(handle, flag);
+      }
+    }
+    return STATUS_OK;
+}
+#endif
+
 /**
   * @brief Sends a 7-bit slave address using the specified I2C peripheral
   */
@@ -69,28 +231,36 @@ void I2Cx_Send7BitAddress(I2C_TypeDef *instance, uint8_t devAddress, uint8_t num
     tmprg |= (reloadEndMode | startStopMode);
     
     instance->CR2 = tmprg;
+    if (startStopMode & I2C_CR2_START) {
+      I2C_TRACE(instance, I2C_TRACE_START, devAddress, numBytes | ((startStopMode & I2C_CR2_RD_WRN) ? 0x8000 : 0));
+    }
 }
 
+#if I2C_CONF_POLLING
 /**
   *@brief Writes data to a specified I2C peripheral in polling mode
+  *@param timeoutUs: Deadline for the whole transaction in microseconds, on expiry the bus is released
+  *@retval STATUS_ERROR if the device NACKed, STATUS_TIMEOUT if the deadline passed
   */
-StatusTypeDef I2Cx_Write(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize)
+StatusTypeDef I2Cx_Write(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize, uint32_t timeoutUs)
 {
    I2C_TypeDef *instance = handle->instance;
-   uint32_t timeout = 0;
+   I2C_DeadlineTypeDef deadline;
   
    if (instance->ISR & I2C_ISR_BUSY || handle->state != I2C_READY)
     {
-      handle->error = I2C_ERROR_BUSY;
-      return STATUS_BUSY;
+      return I2Cx_RejectBusy(handle);
     }
    
+   // One deadline covers the whole transaction, not each byte
+   I2C_Deadline_Start(&deadline, timeoutUs);
+   I2C_TRACE(instance, I2C_TRACE_SUBMIT, I2C_WRITE, dataSize);
    handle->operation = I2C_WRITE;
    I2Cx_ChangeState(handle, I2C_BUSY_TX_SUBADDRESS);
    handle->error = I2C_ERRROR_NONE;
    
    // Disable I2C interrupts since we are polling
-   instance->CR1 &= ~(I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE);
+   instance->CR1 &= ~(I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE | I2C_CR1_TCIE);
    
    I2Cx_Send7BitAddress(instance, devAddress, dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
    
@@ -99,46 +269,55 @@ StatusTypeDef I2Cx_Write(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t
    uint16_t numbytesSent = 0;
    while (numbytesSent < dataSize)
    {
-     timeout = I2C_TIMEOUT;
-     while (!(instance->ISR & I2C_ISR_TXIS))
+     StatusTypeDef status = I2Cx_WaitFlag(handle, I2C_ISR_TXIS, &deadline);
+     if (status != STATUS_OK)
      {
-       if ((timeout--) == 0)
-       {
-         handle->error = I2C_ERROR_TIMEOUT;
-         return STATUS_TIMEOUT;
-       }
+       return status;
      }
      
      instance->TXDR = *(data++);
      numbytesSent++;
    }
    
+   // Wait for the automatic STOP so the bus is free when we return
+   StatusTypeDef status = I2Cx_WaitFlag(handle, I2C_ISR_STOPF, &deadline);
+   if (status != STATUS_OK)
+   {
+     return status;
+   }
+   instance->ICR = I2C_ICR_STOPCF;
+   I2C_TRACE(instance, I2C_TRACE_STOP, 0, 0);
+   
    handle->operation = I2C_NONE;
    I2Cx_ChangeState(handle, I2C_READY);
+   I2C_STATS_INC(handle, transfers);
    
    return STATUS_OK;
 }
 
 /**
   *@brief Reads data from a specified I2C peripheral in polling mode
+  *@param timeoutUs: Deadline for the whole transaction in microseconds, on expiry the bus is released
+  *@retval STATUS_ERROR if the device NACKed, STATUS_TIMEOUT if the deadline passed
   */
-StatusTypeDef I2Cx_Read(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize, uint32_t timeout)
+StatusTypeDef I2Cx_Read(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize, uint32_t timeoutUs)
 {
    I2C_TypeDef *instance = handle->instance;
-   uint32_t timeout = 0;
+   I2C_DeadlineTypeDef deadline;
   
    if (instance->ISR & I2C_ISR_BUSY || handle->state != I2C_READY)
     {
-      handle->error = I2C_ERROR_BUSY;
-      return STATUS_BUSY;
+      return I2Cx_RejectBusy(handle);
     }
    
+   I2C_Deadline_Start(&deadline, timeoutUs);
+   I2C_TRACE(instance, I2C_TRACE_SUBMIT, I2C_READ, dataSize);
    handle->operation = I2C_READ;
    I2Cx_ChangeState(handle, I2C_BUSY_TX_SUBADDRESS);
    handle->error = I2C_ERRROR_NONE;
    
    // Disable I2C interrupts since we are polling
-   instance->CR1 &= ~(I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE);
+   instance->CR1 &= ~(I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE | I2C_CR1_TCIE);
    
    I2Cx_Send7BitAddress(instance, devAddress, dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
    
@@ -147,25 +326,34 @@ StatusTypeDef I2Cx_Read(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *
    uint16_t numbytesRead = 0;
    while (numbytesRead < dataSize)
    {
-     while (!(instance->ISR & I2C_ISR_RXNE))
+     StatusTypeDef status = I2Cx_WaitFlag(handle, I2C_ISR_RXNE, &deadline);
+     if (status != STATUS_OK)
      {
-       if ((timeout--) == 0)
-       {
-         handle->error = I2C_ERROR_TIMEOUT;
-         return STATUS_TIMEOUT;
-       }
+       return status;
      }
      
      *(data++) = instance->RXDR;
      numbytesRead++;
    }
    
+   StatusTypeDef status = I2Cx_WaitFlag(handle, I2C_ISR_STOPF, &deadline);
+   if (status != STATUS_OK)
+   {
+     return status;
+   }
+   instance->ICR = I2C_ICR_STOPCF;
+   I2C_TRACE(instance, I2C_TRACE_STOP, 0, 0);
+   
    handle->operation = I2C_NONE;
    I2Cx_ChangeState(handle, I2C_READY);
+   I2C_STATS_INC(handle, transfers);
    
    return STATUS_OK;
 }
 
+#endif /* I2C_CONF_POLLING */
+
+#if I2C_CONF_IT
 /**
   *@brief Writes data to a specified I2C peripheral in interrupt driven mode
   */
@@ -176,8 +364,7 @@ StatusTypeDef I2Cx_Write_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8
     // Check if the peripheral or handle indicates I2C is busy
     if (instance->ISR & I2C_ISR_BUSY || handle->state != I2C_READY)
     {
-      handle->error = I2C_ERROR_BUSY;
-      return STATUS_BUSY;
+      return I2Cx_RejectBusy(handle);
     }
 
     // Prepare the handle with transmission parameters
@@ -185,16 +372,16 @@ StatusTypeDef I2Cx_Write_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8
     I2Cx_ChangeState(handle, I2C_BUSY_TX);
 
     // Enable needed I2C interrupts
-    instance->CR1 |= (I2C_CR1_TXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE);
+    instance->CR1 |= (I2C_CR1_TXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE | I2C_CR1_TCIE);
 
-    // Address phase
-    I2Cx_Send7BitAddress(instance, devAddress, dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
+    // Address phase, a zero length write only probes for an ACK
+    I2Cx_StartTransfer(handle, dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
 
     return STATUS_OK;
 }
 
 /**
-  *@brief Writes data to a specified I2C peripheral in interrupt driven mode
+  *@brief Reads data from a specified I2C peripheral in interrupt driven mode
   */
 StatusTypeDef I2Cx_Read_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize)
 {
@@ -203,8 +390,7 @@ StatusTypeDef I2Cx_Read_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_
     // Check if the peripheral or handle indicates I2C is busy
     if (instance->ISR & I2C_ISR_BUSY || handle->state != I2C_READY)
     {
-      handle->error = I2C_ERROR_BUSY;
-      return STATUS_BUSY;
+      return I2Cx_RejectBusy(handle);
     }
 
     // Prepare the handle with transmission parameters
@@ -212,14 +398,15 @@ StatusTypeDef I2Cx_Read_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_
     I2Cx_ChangeState(handle, I2C_BUSY_RX);
 
     // Enable needed I2C interrupts
-    instance->CR1 |= (I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE);
+    instance->CR1 |= (I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE | I2C_CR1_TCIE);
 
     // Address phase
-    I2Cx_Send7BitAddress(instance, devAddress, dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
+    I2Cx_StartTransfer(handle, dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
 
     return STATUS_OK;
 }
 
+#if I2C_CONF_MEM
 /**
   * @brief Writes data to a device register using interrupt driven I2C
   * @param handle: Pointer to the I2C handle that interrupts use
@@ -228,11 +415,16 @@ StatusTypeDef I2Cx_MemWrite_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, ui
 {
     I2C_TypeDef *instance = handle->instance;
 
+    // The sub-address is one byte, or two with I2C_CONF_MEM_ADDRESS_16BIT
+    if (memSize == 0 || memSize > sizeof(I2C_MemAddressTypeDef))
+    {
+      return STATUS_ERROR;
+    }
+
     // Check if the peripheral or handle indicates I2C is busy
     if (instance->ISR & I2C_ISR_BUSY || handle->state != I2C_READY)
     {
-      handle->error = I2C_ERROR_BUSY;
-      return STATUS_BUSY;
+      return I2Cx_RejectBusy(handle);
     }
     
     // Prepare the handle with transmission parameters
@@ -240,27 +432,32 @@ StatusTypeDef I2Cx_MemWrite_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, ui
 	I2Cx_ChangeState(handle, I2C_BUSY_TX_SUBADDRESS);
     
     // Enable needed I2C interrupts
-    instance->CR1 |= (I2C_CR1_TXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE);
+    instance->CR1 |= (I2C_CR1_TXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE | I2C_CR1_TCIE);
     
-    // Address phase
-    I2Cx_Send7BitAddress(instance, devAddress, memSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
+    // Sub-address and data go out in one transfer, devices latch the data only if no STOP separates them
+    I2Cx_StartTransfer(handle, (uint32_t)memSize + dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
 
     return STATUS_OK;
 }
 
 /**
-  * @brief Writes data to a device register using interrupt driven I2C
+  * @brief Reads data from a device register using interrupt driven I2C
   * @param handle: Pointer to the I2C handle that interrupts use
   */
 StatusTypeDef I2Cx_MemRead_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint16_t memAddress, uint8_t memSize, uint8_t *data, uint16_t dataSize)
 {
     I2C_TypeDef *instance = handle->instance;
     
+    // The sub-address is one byte, or two with I2C_CONF_MEM_ADDRESS_16BIT
+    if (memSize == 0 || memSize > sizeof(I2C_MemAddressTypeDef))
+    {
+      return STATUS_ERROR;
+    }
+
     // Check if the peripheral or handle indicates I2C is busy
     if (instance->ISR & I2C_ISR_BUSY || handle->state != I2C_READY)
     {
-      handle->error = I2C_ERROR_BUSY;
-      return STATUS_BUSY;
+      return I2Cx_RejectBusy(handle);
     }
     
     // Prepare the handle with transmission parameters
@@ -268,22 +465,24 @@ StatusTypeDef I2Cx_MemRead_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uin
 	I2Cx_ChangeState(handle, I2C_BUSY_TX_SUBADDRESS);
     
     // Enable needed I2C interrupts
-    instance->CR1 |= (I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE);
+    instance->CR1 |= (I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE | I2C_CR1_TCIE);
     
-    // Address phase
-    I2Cx_Send7BitAddress(instance, devAddress, memSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
+    // Sub-address phase without STOP, TC then triggers the repeated START for the read
+    I2Cx_StartTransfer(handle, memSize, I2C_SoftEnd_Mode, I2C_Generate_Start_Write);
 
     return STATUS_OK;
 }
 
+#endif /* I2C_CONF_MEM */
+
 /**
   *@brief Handles I2C NACK interrupts
   */
 void I2Cx_NACKF_CallBack(I2C_HandleTypeDef *handle) {
   handle->error = I2C_ERROR_NACK;
-  if (handle->callBacksEnabled[I2C_NackReceived]) {
-      handle->callBacks->I2C_NackReceivedCallBack(handle);
-  }
+  I2C_STATS_INC(handle, nacks);
+  I2C_TRACE(handle->instance, I2C_TRACE_NACK, handle->state, 0);
+  I2C_CALLBACK(handle, I2C_NackReceived, I2C_NackReceivedCallBack);
 }
 
 /**
@@ -294,26 +493,54 @@ void I2Cx_TXIS_CallBack(I2C_HandleTypeDef *handle) {
   
   switch (handle->state) 
   {
+#if I2C_CONF_MEM
     case I2C_BUSY_TX_SUBADDRESS:
     {
       uint8_t bytesSent = handle->memBytesSent++;
       uint8_t memSize = handle->memSize;
       // Sending address MSB first
       instance->TXDR = (uint8_t)(handle->memAddress >> (((memSize - 1) - bytesSent) * 8)); 
+      if (bytesSent + 1 == memSize && handle->operation == I2C_MEM_WRITE) {
+        // Data follows in the same transfer
+        I2Cx_ChangeState(handle, I2C_BUSY_TX);
+      }
       break;
     }
+#endif
     case I2C_BUSY_TX:
     {
-      uint8_t bytesSent = handle->dataBytesTransmitted++;
-      uint8_t dataSize = handle->dataSize;
-      // Sending data MSB first
-      uint8_t arrSize = dataSize - 1;
-      instance->TXDR = handle->dataBuffer[arrSize - (arrSize - bytesSent)];
+      uint16_t bytesSent = handle->dataBytesTransmitted++;
+      instance->TXDR = handle->dataBuffer[bytesSent];
       break;
     }
+    default:
+      break;
   }
 }
 
+/**
+  *@brief Handles I2C transfer complete reload interrupts, continues a transfer longer than 255 bytes
+  */
+void I2Cx_TCR_CallBack(I2C_HandleTypeDef *handle) {
+  I2C_TypeDef *instance = handle->instance;
+  uint32_t remaining = (uint32_t)handle->dataSize - handle->dataBytesTransmitted;
+  uint32_t tmprg = instance->CR2 & ~(I2C_CR2_NBYTES | I2C_CR2_RELOAD | I2C_CR2_AUTOEND);
+  
+#if I2C_CONF_MEM
+  if (handle->state == I2C_BUSY_TX_SUBADDRESS) {
+    remaining += (uint32_t)handle->memSize - handle->memBytesSent;
+  }
+#endif
+  
+  // Only NBYTES and the end mode may change mid-transfer, writing them clears TCR
+  if (remaining > I2C_MAX_NBYTES) {
+    tmprg |= ((uint32_t)I2C_MAX_NBYTES << I2C_CR2_NBYTES_Pos) | I2C_Reload_Mode;
+  } else {
+    tmprg |= (remaining << I2C_CR2_NBYTES_Pos) | I2C_AutoEnd_Mode;
+  }
+  instance->CR2 = tmprg;
+}
+
 /**
   *@brief Handles I2C reception interrupts
   */
@@ -324,68 +551,82 @@ void I2Cx_RXNE_CallBack(I2C_HandleTypeDef *handle) {
   {
     case I2C_BUSY_RX:
     {
-      uint8_t bytesRead = handle->dataBytesTransmitted++;
-      uint8_t dataSize = handle->dataSize;
-      // Reading data MSB first
-      handle->dataBuffer[(dataSize - 1) - bytesRead++] = instance->RXDR;    
+      uint16_t bytesRead = handle->dataBytesTransmitted++;
+      // Store bytes in the order they arrive so multi-register reads map 1:1 onto the buffer
+      handle->dataBuffer[bytesRead] = instance->RXDR;
       break;
     }
+    default:
+      break;
+  }
+}
+
+#if I2C_CONF_MEM
+/**
+  *@brief Handles I2C transfer complete interrupts, the sub-address of a memory read has been sent
+  */
+void I2Cx_TC_Restart_CallBack(I2C_HandleTypeDef *handle) {
+  if (handle->state == I2C_BUSY_TX_SUBADDRESS && handle->operation == I2C_MEM_READ) {
+    I2Cx_ChangeState(handle, I2C_BUSY_RX);
+    // Repeated START, setting START clears TC
+    I2Cx_StartTransfer(handle, handle->dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
   }
 }
+#endif
 
 /**
   *@brief Handles I2C transmission completed and stop generated interrupts
   */
 void I2Cx_TC_CallBack(I2C_HandleTypeDef *handle) {
-   I2C_TypeDef *instance = handle->instance;
-  
   switch (handle->state)
   {
+#if I2C_CONF_MEM
     case I2C_BUSY_TX_SUBADDRESS:
     {
+      // STOP before the data phase means the device or sub-address was NACKed, complete with the error set
+      I2C_STATS_INC(handle, transfers);
       if (handle->operation == I2C_MEM_WRITE) {
-    	I2Cx_ChangeState(handle, I2C_BUSY_TX);
-        I2Cx_Send7BitAddress(instance, handle->devAddress, handle->dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
-      } else if (handle->operation == I2C_MEM_READ) {
-    	I2Cx_ChangeState(handle, I2C_BUSY_RX);
-        I2Cx_Send7BitAddress(instance, handle->devAddress, handle->dataSize, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
+        I2C_CALLBACK(handle, I2C_MemTxCplt, I2C_MemTxCpltCallBack);
+      } else {
+        I2C_CALLBACK(handle, I2C_MemRxCplt, I2C_MemRxCpltCallBack);
       }
-    }
+      I2Cx_ResetHandle(handle);
       
       break;
     }
+#endif
     case I2C_BUSY_TX:
     {
+      I2C_STATS_INC(handle, transfers);
+#if I2C_CONF_MEM
       if (handle->operation == I2C_MEM_WRITE) {
-        if (handle->callBacksEnabled[I2C_MemTxCplt]) {
-            handle->callBacks->I2C_MemTxCpltCallBack(handle);
-        }
-        I2Cx_ResetHandle(handle);
-      } else if (handle->operation == I2C_WRITE_IT) {
-         if (handle->callBacksEnabled[I2C_WriteCplt]) {
-             handle->callBacks->I2C_WriteCpltCallBack(handle);
-         }
-        I2Cx_ResetHandle(handle);
+        I2C_CALLBACK(handle, I2C_MemTxCplt, I2C_MemTxCpltCallBack);
+      } else
+#endif
+      {
+        I2C_CALLBACK(handle, I2C_WriteCplt, I2C_WriteCpltCallBack);
       }
+      I2Cx_ResetHandle(handle);
       
       break;
     }
     case I2C_BUSY_RX:
     {
+      I2C_STATS_INC(handle, transfers);
+#if I2C_CONF_MEM
       if (handle->operation == I2C_MEM_READ) {
-        if (handle->callBacksEnabled[I2C_MemRxCplt]) {
-            handle->callBacks->I2C_MemRxCpltCallBack(handle);
-        }
-        I2Cx_ResetHandle(handle);
-      } else if (handle->operation == I2C_READ_IT) {
-        if (handle->callBacksEnabled[I2C_ReadCplt]) {
-          handle->callBacks->I2C_ReadCpltCallBack(handle);
-        }
-        I2Cx_ResetHandle(handle);
+        I2C_CALLBACK(handle, I2C_MemRxCplt, I2C_MemRxCpltCallBack);
+      } else
+#endif
+      {
+        I2C_CALLBACK(handle, I2C_ReadCplt, I2C_ReadCpltCallBack);
       }
+      I2Cx_ResetHandle(handle);
       
       break;
     }
+    default:
+      break;
   }
 }
 
@@ -399,15 +640,80 @@ void I2Cx_EV_Handler(I2C_HandleTypeDef *handle)
 {
     I2C_TypeDef *instance = handle->instance;
     uint32_t itflags = instance->ISR;
-    uint32_t itsources = instance->CR1;
     
     if (itflags & I2C_ISR_NACKF) {
+      I2C_TRACE(instance, I2C_TRACE_ISR, 0, I2C_ISR_NACKF);
+      instance->ICR = I2C_ICR_NACKCF;
       I2Cx_NACKF_CallBack(handle);
     } else if (itflags & I2C_ISR_RXNE) {
+      I2C_TRACE(instance, I2C_TRACE_ISR, 0, I2C_ISR_RXNE);
       I2Cx_RXNE_CallBack(handle);
     } else if (itflags & I2C_ISR_TXIS) {
+      I2C_TRACE(instance, I2C_TRACE_ISR, 0, I2C_ISR_TXIS);
       I2Cx_TXIS_CallBack(handle);
+    } else if (itflags & I2C_ISR_TCR) {
+      I2C_TRACE(instance, I2C_TRACE_ISR, 0, I2C_ISR_TCR);
+      I2Cx_TCR_CallBack(handle);
+#if I2C_CONF_MEM
+    } else if (itflags & I2C_ISR_TC) {
+      I2C_TRACE(instance, I2C_TRACE_ISR, 0, I2C_ISR_TC);
+      I2Cx_TC_Restart_CallBack(handle);
+#endif
     } else if (itflags & (I2C_ISR_STOPF)) {
+      I2C_TRACE(instance, I2C_TRACE_ISR, 0, I2C_ISR_STOPF);
+      instance->ICR = I2C_ICR_STOPCF;
+      I2C_TRACE(instance, I2C_TRACE_STOP, 0, 0);
       I2Cx_TC_CallBack(handle);
     }
 }
+
+/**
+  *@brief Aborts an interrupt driven transfer that has passed its deadline.
+  *       Should be called from a periodic timer interrupt running at the same
+  *       priority as the I2Cx event interrupt, the period sets the timeout resolution.
+
+  *@param handle: Pointer to a I2C handle
+  */
+void I2Cx_TimeoutTick(I2C_HandleTypeDef *handle)
+{
+    // Idle, or a polling transfer that enforces its own deadline
+    if (handle->state == I2C_READY || handle->operation == I2C_WRITE || handle->operation == I2C_READ) {
+      return;
+    }
+    if (!I2C_Deadline_Expired(&handle->deadline)) {
+      return;
+    }
+    
+    I2Cx_Abort(handle);
+    handle->error = I2C_ERROR_TIMEOUT;
+    I2C_STATS_INC(handle, timeouts);
+    I2C_TRACE(handle->instance, I2C_TRACE_TIMEOUT, handle->state, 0);
+#if I2C_CONF_CALLBACKS
+    if (handle->timeoutCallBack != NULL) {
+      I2C_TRACE(handle->instance, I2C_TRACE_CALLBACK, I2C_Timeout, 0);
+      handle->timeoutCallBack(handle);
+    }
+#endif
+    I2Cx_ResetHandle(handle);
+}
+
+/**
+  *@brief Aborts the interrupt driven transfer in progress without running any callback,
+  *       for callers that gave up waiting themselves. Counted as a timeout.
+  *       Call with the I2Cx event interrupt masked.
+
+  *@param handle: Pointer to a I2C handle
+  */
+void I2Cx_Abort_IT(I2C_HandleTypeDef *handle)
+{
+    if (handle->state == I2C_READY) {
+      return;
+    }
+    
+    I2Cx_Abort(handle);
+    I2C_STATS_INC(handle, timeouts);
+    I2C_TRACE(handle->instance, I2C_TRACE_TIMEOUT, handle->state, 0);
+    I2Cx_ResetHandle(handle);
+}
+
+#endif /* I2C_CONF_IT */
@@ -1,17 +1,22 @@
 #ifndef __i2c_H
 #define __i2c_H
 
+#include "i2c_conf.h"
+#include "i2c_clock.h"
 
 /*-------------------------IMPORTANT-------------------------*/
 // Import the correct STM32 CMSIS header for your device
 // Call the I2Cx_EV_Handler from the function that overwrites/implements the IVT entry for I2Cx interrupt events
+// Call I2Cx_TimeoutTick from a periodic timer interrupt at the same priority as the I2Cx event interrupt
+// Timeouts are in microseconds against the clock registered with I2C_Clock_SetSource (see i2c_clock.h)
 /* The following callbacks can be overwritten to implement functionality dependent on transmission completion:
  * I2C_WriteCpltCallBack
  * I2C_ReadCpltCallBack
  * I2C_MemTxCpltCallBack
  * I2C_MemRxCpltCallBack
  * I2C_NackReceivedCallBack
- * /
+ * The timeout callback is set separately with I2Cx_SetTimeoutCallBack
+ */
 
 
 /** @defgroup I2C_reloadEndMode_definition
@@ -29,6 +34,8 @@
 #define  I2C_Generate_Start_Read       (uint32_t)(I2C_CR2_START | I2C_CR2_RD_WRN)
 #define  I2C_Generate_Start_Write      I2C_CR2_START
 
+#define  I2C_MAX_NBYTES                255
+
 
 typedef enum {
     I2C_ERRROR_NONE   = 0x00,
@@ -60,10 +67,25 @@ typedef enum {
      I2C_MemTxCplt    = 0x02,
      I2C_MemRxCplt    = 0x03,
      I2C_NackReceived = 0x04,
+     I2C_Timeout      = 0x05,     // Not part of I2C_CallBackHandleTypeDef, see I2Cx_SetTimeoutCallBack
 } I2C_CallBackTypeDef;
 
-typedef I2C_CallBackHandleStruct I2C_CallBackHandleTypeDef;
-typedef I2C_HandleStruct I2C_HandleTypeDef;
+#define I2C_NUM_CALLBACKS              5
+
+#if I2C_CONF_MEM_ADDRESS_16BIT
+typedef uint16_t I2C_MemAddressTypeDef;
+#else
+typedef uint8_t I2C_MemAddressTypeDef;
+#endif
+
+typedef struct {
+    uint32_t transfers;
+    uint32_t nacks;
+    uint32_t timeouts;
+} I2C_StatsTypeDef;
+
+typedef struct I2C_CallBackHandleStruct I2C_CallBackHandleTypeDef;
+typedef struct I2C_HandleStruct I2C_HandleTypeDef;
 
 struct I2C_CallBackHandleStruct {
     void (*I2C_WriteCpltCallBack)(I2C_HandleTypeDef *handle);
@@ -73,34 +95,76 @@ struct I2C_CallBackHandleStruct {
     void (*I2C_NackReceivedCallBack)(I2C_HandleTypeDef *handle);
 };
 
+typedef void (*I2C_TimeoutCallBackTypeDef)(I2C_HandleTypeDef *handle);
+
+/* Fields are ordered largest first. state, error and operation are written by both the
+ * thread side and the interrupt, so each gets its own byte and a store never rewrites
+ * its neighbours. memSize and memBytesSent are only packed because the thread side
+ * writes them before the transfer starts and the interrupt afterwards.
+ */
 struct I2C_HandleStruct {
     I2C_TypeDef *instance;
-    volatile I2C_StateTypeDef state;
-    volatile I2C_StateTypeDef previousState;
-    volatile I2C_ErrorTypeDef error;
-    volatile I2C_OperationTypeDef operation;
-    uint16_t memAddress;
-    uint8_t memSize;
     uint8_t *dataBuffer;
+#if I2C_CONF_CALLBACKS
+    I2C_CallBackHandleTypeDef *callBacks;
+#if I2C_CONF_IT
+    I2C_TimeoutCallBackTypeDef timeoutCallBack;
+#endif
+#endif
+#if I2C_CONF_IT
+    uint32_t timeoutUs;
+    I2C_DeadlineTypeDef deadline;
+#endif
+#if I2C_CONF_STATS
+    I2C_StatsTypeDef stats;
+#endif
     uint16_t dataSize;
-    uint8_t devAddress;
     uint16_t dataBytesTransmitted;
-    uint16_t memBytesSent;
-    uint8_t callBacksEnabled[5];
-    I2C_CallBackHandleTypeDef callBacks;
+#if I2C_CONF_MEM
+    I2C_MemAddressTypeDef memAddress;
+#endif
+    uint8_t devAddress;
+    volatile uint8_t state;                 // I2C_StateTypeDef
+    volatile uint8_t error;                 // I2C_ErrorTypeDef
+    volatile uint8_t operation;             // I2C_OperationTypeDef
+#if I2C_CONF_PREVIOUS_STATE
+    volatile uint8_t previousState;         // I2C_StateTypeDef
+#endif
+#if I2C_CONF_MEM
+    uint8_t memSize : 2;
+    uint8_t memBytesSent : 2;
+#endif
+#if I2C_CONF_CALLBACKS
+    uint8_t callBacksEnabled;               // Bit n set enables I2C_CallBackTypeDef n
+#endif
 };
 
 
 /* Global functions */
 void I2Cx_Send7BitAddress(I2C_TypeDef *instance, uint8_t devAddress, uint8_t numBytes, uint32_t reloadEndMode, uint32_t startStopMode);
 void I2Cx_Init(I2C_HandleTypeDef *handle, I2C_TypeDef *instance);
-void I2Cx_AddCallBacks(I2C_HandleTypeDef *handle, I2C_CallBackHandle *callBacks, uint8_t callBacksEnabled[5]);
-StatusTypeDef I2Cx_Write(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize, uint32_t timeout);
-StatusTypeDef I2Cx_Read(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize, uint32_t timeout);
+#if I2C_CONF_CALLBACKS
+void I2Cx_AddCallBacks(I2C_HandleTypeDef *handle, I2C_CallBackHandleTypeDef *callBacks, uint8_t callBacksEnabled[I2C_NUM_CALLBACKS]);
+#endif
+#if I2C_CONF_POLLING
+StatusTypeDef I2Cx_Write(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize, uint32_t timeoutUs);
+StatusTypeDef I2Cx_Read(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize, uint32_t timeoutUs);
+#endif
+#if I2C_CONF_IT
+void I2Cx_SetTimeout(I2C_HandleTypeDef *handle, uint32_t timeoutUs);
 StatusTypeDef I2Cx_Write_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize);
+StatusTypeDef I2Cx_Read_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint8_t *data, uint16_t dataSize);
+void I2Cx_EV_Handler(I2C_HandleTypeDef *handle);
+void I2Cx_TimeoutTick(I2C_HandleTypeDef *handle);
+#if I2C_CONF_CALLBACKS
+void I2Cx_SetTimeoutCallBack(I2C_HandleTypeDef *handle, I2C_TimeoutCallBackTypeDef callBack);
+#endif
+void I2Cx_Abort_IT(I2C_HandleTypeDef *handle);
+#endif
+#if I2C_CONF_MEM
 StatusTypeDef I2Cx_MemWrite_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint16_t memAddress, uint8_t memSize, uint8_t *data, uint16_t dataSize);
 StatusTypeDef I2Cx_MemRead_IT(I2C_HandleTypeDef *handle, uint8_t devAddress, uint16_t memAddress, uint8_t memSize, uint8_t *data, uint16_t dataSize);
-void I2Cx_EV_Handler(I2C_HandleTypeDef *handle);
+#endif
 
 
 #endif
@@ -0,0 +1,31 @@
+#include "i2c_clock.h"
+#include <stddef.h>
+
+static volatile I2C_Clock_SourceTypeDef I2C_Clock_Source = NULL;
+
+void I2C_Clock_SetSource(I2C_Clock_SourceTypeDef nowUs) {
+    I2C_Clock_Source = nowUs;
+}
+
+uint32_t I2C_Clock_NowUs(void) {
+    I2C_Clock_SourceTypeDef source = I2C_Clock_Source;
+    return (source != NULL) ? source() : 0;
+}
+
+/**
+  * @brief Arms a deadline timeoutUs microseconds from now, I2C_TIMEOUT_INFINITE never expires
+  */
+void I2C_Deadline_Start(I2C_DeadlineTypeDef *deadline, uint32_t timeoutUs) {
+    deadline->start = I2C_Clock_NowUs();
+    deadline->duration = timeoutUs;
+}
+
+/**
+  * @brief Wrap-safe expiry check against the registered clock source
+  */
+uint8_t I2C_Deadline_Expired(const I2C_DeadlineTypeDef *deadline) {
+    if (deadline->duration == I2C_TIMEOUT_INFINITE) {
+        return 0;
+    }
+    return (uint32_t)(I2C_Clock_NowUs() - deadline->start) >= deadline->duration;
+}
@@ -0,0 +1,40 @@
+#ifndef __i2c_clock_H
+#define __i2c_clock_H
+
+#include <stdint.h>
+
+
+/*-------------------------IMPORTANT-------------------------*/
+// Register a monotonic microsecond source with I2C_Clock_SetSource before using any timeouts
+// Ports live in I2C/port: DWT cycle counter, SysTick, or clock_gettime on a POSIX host
+// Without a source the clock reads 0 and no deadline ever expires
+/* The source may wrap at 2^32 microseconds, deadlines are compared with unsigned
+ * subtraction so a single timeout can be up to ~71 minutes long.
+ */
+
+
+#define I2C_TIMEOUT_INFINITE           ((uint32_t)0xFFFFFFFF)
+
+typedef uint32_t (*I2C_Clock_SourceTypeDef)(void);
+
+typedef struct {
+    uint32_t start;
+    uint32_t duration;
+} I2C_DeadlineTypeDef;
+
+
+/* Global functions */
+void I2C_Clock_SetSource(I2C_Clock_SourceTypeDef nowUs);
+uint32_t I2C_Clock_NowUs(void);
+void I2C_Deadline_Start(I2C_DeadlineTypeDef *deadline, uint32_t timeoutUs);
+uint8_t I2C_Deadline_Expired(const I2C_DeadlineTypeDef *deadline);
+
+/* Port sources, link the one matching the platform */
+void I2C_Clock_DWT_Init(void);
+uint32_t I2C_Clock_DWT_NowUs(void);
+void I2C_Clock_SysTick_Handler(void);
+uint32_t I2C_Clock_SysTick_NowUs(void);
+uint32_t I2C_Clock_POSIX_NowUs(void);
+
+
+#endif
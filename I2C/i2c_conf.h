@@ -0,0 +1,67 @@
+#ifndef __i2c_conf_H
+#define __i2c_conf_H
+
+
+/*-------------------------IMPORTANT-------------------------*/
+// Compile-time feature selection for the I2C driver, override any of these with -D on the command line
+// or point I2C_CONF_USER_HEADER at a project header, e.g. -DI2C_CONF_USER_HEADER='"my_i2c_conf.h"'
+// Disabled features are stripped from both the handle and the code, run tools/i2c_size_report.sh to compare profiles
+
+#ifdef I2C_CONF_USER_HEADER
+#include I2C_CONF_USER_HEADER
+#endif
+
+
+/** @defgroup I2C_conf_modes
+  * @{
+  */
+#ifndef I2C_CONF_POLLING
+#define I2C_CONF_POLLING               1    // I2Cx_Write / I2Cx_Read
+#endif
+
+#ifndef I2C_CONF_IT
+#define I2C_CONF_IT                    1    // *_IT functions, I2Cx_EV_Handler and I2Cx_TimeoutTick
+#endif
+
+#ifndef I2C_CONF_MEM
+#define I2C_CONF_MEM                   1    // I2Cx_MemWrite_IT / I2Cx_MemRead_IT
+#endif
+
+/** @defgroup I2C_conf_features
+  * @{
+  */
+#ifndef I2C_CONF_CALLBACKS
+#define I2C_CONF_CALLBACKS             1    // Completion callbacks through I2Cx_AddCallBacks
+#endif
+
+#ifndef I2C_CONF_STATS
+#define I2C_CONF_STATS                 0    // Transfer, NACK and timeout counters in handle->stats
+#endif
+
+#ifndef I2C_CONF_PREVIOUS_STATE
+#define I2C_CONF_PREVIOUS_STATE        1    // Keep handle->previousState for debugging
+#endif
+
+#ifndef I2C_CONF_MEM_ADDRESS_16BIT
+#define I2C_CONF_MEM_ADDRESS_16BIT     1    // 0 limits memAddress to 8 bits and memSize to 1
+#endif
+
+#ifndef I2C_CONF_TRACE
+#define I2C_CONF_TRACE                 0    // Record driver events into I2C_Trace_Ring, see i2c_trace.h
+#endif
+
+#ifndef I2C_TRACE_SIZE
+#define I2C_TRACE_SIZE                 128  // Trace ring capacity in events (8 bytes each), power of two
+#endif
+
+
+#if I2C_CONF_MEM && !I2C_CONF_IT
+#error "I2C_CONF_MEM requires I2C_CONF_IT"
+#endif
+
+#if !I2C_CONF_POLLING && !I2C_CONF_IT
+#error "Enable at least one of I2C_CONF_POLLING or I2C_CONF_IT"
+#endif
+
+
+#endif
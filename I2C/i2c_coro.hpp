@@ -0,0 +1,307 @@
+#ifndef __i2c_coro_HPP
+#define __i2c_coro_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <exception>
+#include <span>
+#include <utility>
+
+extern "C" {
+#include "i2c.h"
+}
+
+#if !I2C_CONF_IT || !I2C_CONF_CALLBACKS
+#error "i2c_coro requires I2C_CONF_IT and I2C_CONF_CALLBACKS"
+#endif
+
+
+/*-------------------------IMPORTANT-------------------------*/
+// Header-only C++20 front-end over the interrupt driven I2C API, build with -std=c++20 (-fno-exceptions is fine)
+// Call I2Cx_EV_Handler(&bus.handle()) from the I2Cx event interrupt as usual
+// Call scheduler.runPending() from the main loop, coroutines are only ever resumed from there
+// Per-operation timeouts come from I2Cx_SetTimeout(&bus.handle(), us) with I2Cx_TimeoutTick running
+// One operation per Bus at a time, co_await on a Bus that is still busy yields STATUS_BUSY without suspending
+/* Coroutine frames come from a static pool, nothing touches the heap. Size the pool with
+ * I2C_CORO_FRAME_SIZE / I2C_CORO_FRAME_COUNT and check framePool.largestRequest() on the
+ * target, the compiler decides the frame size. A Task that evaluates to false didn't get a frame.
+ * All buses sharing a Scheduler must have their event interrupts at the same priority,
+ * the ready queue is single producer.
+ */
+
+
+#ifndef I2C_CORO_FRAME_SIZE
+#define I2C_CORO_FRAME_SIZE            384
+#endif
+
+#ifndef I2C_CORO_FRAME_COUNT
+#define I2C_CORO_FRAME_COUNT           2
+#endif
+
+#ifndef I2C_CORO_READY_QUEUE_SIZE
+#define I2C_CORO_READY_QUEUE_SIZE      8
+#endif
+
+
+namespace i2c {
+
+/**
+  * @brief Fixed block allocator backing the coroutine frames, only used from thread context
+  */
+template <std::size_t BlockSize, std::size_t BlockCount>
+class FramePool {
+    static_assert(BlockCount > 0 && BlockCount <= 32, "FramePool tracks blocks in a 32-bit mask");
+
+public:
+    void *allocate(std::size_t size) noexcept {
+        if (size > largestRequest_) {
+            largestRequest_ = size;
+        }
+        if (size > BlockSize) {
+            return nullptr;
+        }
+        for (std::size_t i = 0; i < BlockCount; i++) {
+            std::uint32_t mask = (std::uint32_t)1 << i;
+            if (!(used_ & mask)) {
+                used_ |= mask;
+                return blocks_[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void deallocate(void *frame) noexcept {
+        std::size_t i = (static_cast<unsigned char *>(frame) - blocks_[0]) / BlockSize;
+        used_ &= ~((std::uint32_t)1 << i);
+    }
+
+    std::size_t blocksInUse() const noexcept { return __builtin_popcount(used_); }
+    std::size_t largestRequest() const noexcept { return largestRequest_; }
+
+private:
+    alignas(std::max_align_t) unsigned char blocks_[BlockCount][BlockSize];
+    std::uint32_t used_ = 0;
+    std::size_t largestRequest_ = 0;
+};
+
+inline FramePool<I2C_CORO_FRAME_SIZE, I2C_CORO_FRAME_COUNT> framePool;
+
+
+/**
+  * @brief Fire-and-forget coroutine, starts eagerly and releases its frame when it returns
+  */
+class Task {
+public:
+    struct promise_type {
+        static void *operator new(std::size_t size) noexcept { return framePool.allocate(size); }
+        static void operator delete(void *frame) noexcept { framePool.deallocate(frame); }
+        static Task get_return_object_on_allocation_failure() noexcept { return Task(false); }
+
+        Task get_return_object() noexcept { return Task(true); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    explicit operator bool() const noexcept { return started_; }
+
+private:
+    explicit Task(bool started) : started_(started) {}
+    bool started_;
+};
+
+
+/**
+  * @brief Ready queue filled from I2C interrupts and drained from the main loop
+  */
+class Scheduler {
+    static_assert((I2C_CORO_READY_QUEUE_SIZE & (I2C_CORO_READY_QUEUE_SIZE - 1)) == 0, "Ready queue size must be a power of two");
+    // Every suspended pool Task holds at most one slot, so wake() can never find the queue full
+    static_assert(I2C_CORO_FRAME_COUNT <= I2C_CORO_READY_QUEUE_SIZE, "Ready queue must fit one entry per coroutine frame");
+
+public:
+    /**
+      * @brief Queues a suspended coroutine for resumption, called from interrupt context
+      */
+    bool post(std::coroutine_handle<> handle) noexcept {
+        std::uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == I2C_CORO_READY_QUEUE_SIZE) {
+            return false;
+        }
+        ready_[head & (I2C_CORO_READY_QUEUE_SIZE - 1)] = handle;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+      * @brief Resumes every coroutine that was ready on entry
+      * @retval Number of coroutines resumed
+      */
+    std::uint32_t runPending() noexcept {
+        std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+        std::uint32_t head = head_.load(std::memory_order_acquire);
+        std::uint32_t resumed = head - tail;
+
+        while (tail != head) {
+            std::coroutine_handle<> handle = ready_[tail & (I2C_CORO_READY_QUEUE_SIZE - 1)];
+            tail_.store(++tail, std::memory_order_release);
+            handle.resume();
+        }
+        return resumed;
+    }
+
+private:
+    std::coroutine_handle<> ready_[I2C_CORO_READY_QUEUE_SIZE];
+    std::atomic<std::uint32_t> head_{0};
+    std::atomic<std::uint32_t> tail_{0};
+};
+
+
+/**
+  * @brief One I2C peripheral, owns the C handle and resumes the awaiting coroutine from its callbacks
+  */
+class Bus {
+public:
+    class Operation;
+
+    Bus(I2C_TypeDef *instance, Scheduler &scheduler) : scheduler_(&scheduler) {
+        static I2C_CallBackHandleTypeDef callBacks = {
+            &Bus::cpltCallBack,
+            &Bus::cpltCallBack,
+            &Bus::cpltCallBack,
+            &Bus::cpltCallBack,
+            nullptr,
+        };
+        // A NACK is reported by the STOP that follows it, waking on the NACK would resume before the handle is READY
+        uint8_t callBacksEnabled[I2C_NUM_CALLBACKS] = {1, 1, 1, 1, 0};
+
+        I2Cx_Init(&handle_, instance);
+        I2Cx_AddCallBacks(&handle_, &callBacks, callBacksEnabled);
+        I2Cx_SetTimeoutCallBack(&handle_, &Bus::timeoutCallBack);
+    }
+
+    Bus(const Bus &) = delete;
+    Bus &operator=(const Bus &) = delete;
+
+    I2C_HandleTypeDef &handle() noexcept { return handle_; }
+
+    Operation write(uint8_t devAddress, std::span<uint8_t> data) noexcept;
+    Operation read(uint8_t devAddress, std::span<uint8_t> data) noexcept;
+    Operation memWrite(uint8_t devAddress, uint8_t memAddress, std::span<uint8_t> data) noexcept;
+    Operation memRead(uint8_t devAddress, uint8_t memAddress, std::span<uint8_t> data) noexcept;
+
+private:
+    static Bus *fromHandle(I2C_HandleTypeDef *handle) noexcept {
+        // handle_ is the first member of a standard-layout class
+        return reinterpret_cast<Bus *>(handle);
+    }
+
+    // Takes the waiter exactly once per transfer
+    void wake(I2C_ErrorTypeDef error) noexcept {
+        std::coroutine_handle<> waiter = std::exchange(waiter_, nullptr);
+        if (waiter) {
+            error_ = error;
+            scheduler_->post(waiter);
+        }
+    }
+
+    static void cpltCallBack(I2C_HandleTypeDef *handle) { fromHandle(handle)->wake((I2C_ErrorTypeDef)handle->error); }
+    static void timeoutCallBack(I2C_HandleTypeDef *handle) { fromHandle(handle)->wake(I2C_ERROR_TIMEOUT); }
+
+    I2C_HandleTypeDef handle_;
+    Scheduler *scheduler_;
+    std::coroutine_handle<> waiter_;
+    I2C_ErrorTypeDef error_ = I2C_ERRROR_NONE;
+};
+
+
+/**
+  * @brief Awaitable for a single interrupt driven transfer, co_await yields its StatusTypeDef
+  */
+class Bus::Operation {
+public:
+    Operation(Bus &bus, I2C_OperationTypeDef operation, uint8_t devAddress, uint8_t memAddress, std::span<uint8_t> data) noexcept
+        : bus_(bus), operation_(operation), devAddress_(devAddress), memAddress_(memAddress), data_(data) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> waiter) noexcept {
+        I2C_HandleTypeDef *handle = &bus_.handle_;
+        uint16_t dataSize = (uint16_t)data_.size();
+
+        // One operation at a time per Bus, a second awaiter gets STATUS_BUSY and must not touch the first one's waiter
+        if (bus_.waiter_ || handle->state != I2C_READY) {
+            status_ = STATUS_BUSY;
+            return false;
+        }
+
+        // The completion may fire before I2Cx_*_IT returns, so the waiter is published first
+        bus_.waiter_ = waiter;
+        bus_.error_ = I2C_ERRROR_NONE;
+
+        switch (operation_)
+        {
+          case I2C_WRITE_IT:
+            status_ = I2Cx_Write_IT(handle, devAddress_, data_.data(), dataSize);
+            break;
+          case I2C_READ_IT:
+            status_ = I2Cx_Read_IT(handle, devAddress_, data_.data(), dataSize);
+            break;
+          case I2C_MEM_WRITE:
+            status_ = I2Cx_MemWrite_IT(handle, devAddress_, memAddress_, 1, data_.data(), dataSize);
+            break;
+          default:
+            status_ = I2Cx_MemRead_IT(handle, devAddress_, memAddress_, 1, data_.data(), dataSize);
+            break;
+        }
+
+        if (status_ != STATUS_OK) {
+            // Nothing was started, withdraw the waiter published above and continue without suspending
+            bus_.waiter_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    StatusTypeDef await_resume() const noexcept {
+        if (status_ == STATUS_OK && bus_.error_ == I2C_ERROR_TIMEOUT) {
+            return STATUS_TIMEOUT;
+        }
+        if (status_ == STATUS_OK && bus_.error_ != I2C_ERRROR_NONE) {
+            return STATUS_ERROR;
+        }
+        return status_;
+    }
+
+private:
+    Bus &bus_;
+    I2C_OperationTypeDef operation_;
+    uint8_t devAddress_;
+    uint8_t memAddress_;
+    std::span<uint8_t> data_;
+    StatusTypeDef status_ = STATUS_OK;
+};
+
+inline Bus::Operation Bus::write(uint8_t devAddress, std::span<uint8_t> data) noexcept {
+    return Operation(*this, I2C_WRITE_IT, devAddress, 0, data);
+}
+
+inline Bus::Operation Bus::read(uint8_t devAddress, std::span<uint8_t> data) noexcept {
+    return Operation(*this, I2C_READ_IT, devAddress, 0, data);
+}
+
+inline Bus::Operation Bus::memWrite(uint8_t devAddress, uint8_t memAddress, std::span<uint8_t> data) noexcept {
+    return Operation(*this, I2C_MEM_WRITE, devAddress, memAddress, data);
+}
+
+inline Bus::Operation Bus::memRead(uint8_t devAddress, uint8_t memAddress, std::span<uint8_t> data) noexcept {
+    return Operation(*this, I2C_MEM_READ, devAddress, memAddress, data);
+}
+
+} // namespace i2c
+
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef __i2c_os_H
+#define __i2c_os_H
+
+#include <stdint.h>
+#include "commons.h"
+
+
+/*-------------------------IMPORTANT-------------------------*/
+// Define exactly one of I2C_OS_FREERTOS or I2C_OS_POSIX and link the matching port from I2C/port
+// The FreeRTOS port allocates statically, configSUPPORT_STATIC_ALLOCATION must be enabled
+// On POSIX the thread standing in for the I2C interrupt must hold I2C_OS_EnterCritical while it runs the handlers
+
+
+#define I2C_OS_WAIT_FOREVER            ((uint32_t)0xFFFFFFFF)
+
+#if defined(I2C_OS_FREERTOS)
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+
+typedef struct {
+    SemaphoreHandle_t handle;
+    StaticSemaphore_t buffer;
+} I2C_OS_MutexTypeDef;
+
+typedef struct {
+    SemaphoreHandle_t handle;
+    StaticSemaphore_t buffer;
+} I2C_OS_SemaphoreTypeDef;
+
+#elif defined(I2C_OS_POSIX)
+
+#include <pthread.h>
+
+typedef struct {
+    pthread_mutex_t lock;
+} I2C_OS_MutexTypeDef;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t given;
+} I2C_OS_SemaphoreTypeDef;
+
+#else
+#error "i2c_os.h: define I2C_OS_FREERTOS or I2C_OS_POSIX"
+#endif
+
+
+/* Global functions */
+StatusTypeDef I2C_OS_MutexCreate(I2C_OS_MutexTypeDef *mutex);
+StatusTypeDef I2C_OS_MutexLock(I2C_OS_MutexTypeDef *mutex, uint32_t timeoutMs);
+void I2C_OS_MutexUnlock(I2C_OS_MutexTypeDef *mutex);
+StatusTypeDef I2C_OS_SemaphoreCreate(I2C_OS_SemaphoreTypeDef *semaphore);
+StatusTypeDef I2C_OS_SemaphoreTake(I2C_OS_SemaphoreTypeDef *semaphore, uint32_t timeoutMs);
+void I2C_OS_SemaphoreGiveFromISR(I2C_OS_SemaphoreTypeDef *semaphore);
+void I2C_OS_EnterCritical(void);
+void I2C_OS_ExitCritical(void);
+
+
+#endif
@@ -0,0 +1,131 @@
+#include "i2c_rtos.h"
+
+static void I2Cx_RTOS_CpltCallBack(I2C_HandleTypeDef *handle);
+static void I2Cx_RTOS_TimeoutCallBack(I2C_HandleTypeDef *handle);
+
+static I2C_CallBackHandleTypeDef I2Cx_RTOS_CallBacks = {
+    .I2C_WriteCpltCallBack    = I2Cx_RTOS_CpltCallBack,
+    .I2C_ReadCpltCallBack     = I2Cx_RTOS_CpltCallBack,
+    .I2C_MemTxCpltCallBack    = I2Cx_RTOS_CpltCallBack,
+    .I2C_MemRxCpltCallBack    = I2Cx_RTOS_CpltCallBack,
+    .I2C_NackReceivedCallBack = NULL,
+};
+
+/**
+  * @brief Wakes the task waiting in I2Cx_Transfer, runs in interrupt context.
+  *        A NACK is reported here too, through the STOP that follows it.
+  */
+static void I2Cx_RTOS_CpltCallBack(I2C_HandleTypeDef *handle) {
+    I2C_RTOS_HandleTypeDef *rtosHandle = (I2C_RTOS_HandleTypeDef *)handle;
+
+    // The handle is reset right after this callback returns, keep the error for the waiter
+    rtosHandle->transferError = handle->error;
+    I2C_OS_SemaphoreGiveFromISR(&rtosHandle->transferDone);
+}
+
+/**
+  * @brief I2Cx_TimeoutTick aborted the transfer, the bus is already released
+  */
+static void I2Cx_RTOS_TimeoutCallBack(I2C_HandleTypeDef *handle) {
+    I2C_RTOS_HandleTypeDef *rtosHandle = (I2C_RTOS_HandleTypeDef *)handle;
+
+    rtosHandle->transferError = I2C_ERROR_TIMEOUT;
+    I2C_OS_SemaphoreGiveFromISR(&rtosHandle->transferDone);
+}
+
+/**
+  * @brief Converts a transfer timeout to the OS wait, which only backs up I2Cx_TimeoutTick
+  */
+static uint32_t I2Cx_RTOS_WaitMs(uint32_t timeoutUs) {
+    if (timeoutUs == I2C_TIMEOUT_INFINITE) {
+        return I2C_OS_WAIT_FOREVER;
+    }
+    return timeoutUs / 1000 + I2C_RTOS_TIMEOUT_MARGIN_MS;
+}
+
+/**
+  * @brief The OS wait expired before any callback, stops the transfer so it can't outlive I2Cx_Transfer
+  */
+static void I2Cx_RTOS_Backstop(I2C_RTOS_HandleTypeDef *rtosHandle) {
+    I2C_OS_EnterCritical();
+    if (rtosHandle->handle.state != I2C_READY) {
+        I2Cx_Abort_IT(&rtosHandle->handle);
+        rtosHandle->transferError = I2C_ERROR_TIMEOUT;
+    }
+    I2C_OS_ExitCritical();
+
+    // Either the abort above or a completion that raced the wait, no give may be left for the next transfer
+    I2C_OS_SemaphoreTake(&rtosHandle->transferDone, 0);
+}
+
+/**
+  * @brief Initialises the I2C handle together with its bus mutex and completion semaphore
+  */
+StatusTypeDef I2Cx_RTOS_Init(I2C_RTOS_HandleTypeDef *rtosHandle, I2C_TypeDef *instance) {
+    // The handle is only READY again after the STOP, so the NACK itself must not wake the waiter
+    uint8_t callBacksEnabled[I2C_NUM_CALLBACKS] = {1, 1, 1, 1, 0};
+
+    I2Cx_Init(&rtosHandle->handle, instance);
+    I2Cx_AddCallBacks(&rtosHandle->handle, &I2Cx_RTOS_CallBacks, callBacksEnabled);
+    I2Cx_SetTimeoutCallBack(&rtosHandle->handle, I2Cx_RTOS_TimeoutCallBack);
+    rtosHandle->transferError = I2C_ERRROR_NONE;
+
+    if (I2C_OS_MutexCreate(&rtosHandle->busLock) != STATUS_OK) {
+        return STATUS_ERROR;
+    }
+    return I2C_OS_SemaphoreCreate(&rtosHandle->transferDone);
+}
+
+/**
+  * @brief Performs an interrupt driven transfer and sleeps until it completes
+  * @param operation: One of I2C_WRITE_IT, I2C_READ_IT, I2C_MEM_WRITE or I2C_MEM_READ
+  * @param timeoutUs: Transfer deadline enforced by I2Cx_TimeoutTick, also bounds waiting for the bus
+  * @retval STATUS_OK, STATUS_BUSY if the peripheral is held outside this API,
+  *         STATUS_TIMEOUT, or STATUS_ERROR on NACK
+  */
+StatusTypeDef I2Cx_Transfer(I2C_RTOS_HandleTypeDef *rtosHandle, I2C_OperationTypeDef operation, uint8_t devAddress, uint16_t memAddress, uint8_t memSize, uint8_t *data, uint16_t dataSize, uint32_t timeoutUs)
+{
+    I2C_HandleTypeDef *handle = &rtosHandle->handle;
+    uint32_t waitMs = I2Cx_RTOS_WaitMs(timeoutUs);
+    StatusTypeDef status;
+
+    if (I2C_OS_MutexLock(&rtosHandle->busLock, waitMs) != STATUS_OK) {
+        return STATUS_TIMEOUT;
+    }
+
+    rtosHandle->transferError = I2C_ERRROR_NONE;
+    I2Cx_SetTimeout(handle, timeoutUs);
+
+    switch (operation)
+    {
+      case I2C_WRITE_IT:
+        status = I2Cx_Write_IT(handle, devAddress, data, dataSize);
+        break;
+      case I2C_READ_IT:
+        status = I2Cx_Read_IT(handle, devAddress, data, dataSize);
+        break;
+      case I2C_MEM_WRITE:
+        status = I2Cx_MemWrite_IT(handle, devAddress, memAddress, memSize, data, dataSize);
+        break;
+      case I2C_MEM_READ:
+        status = I2Cx_MemRead_IT(handle, devAddress, memAddress, memSize, data, dataSize);
+        break;
+      default:
+        status = STATUS_ERROR;
+        break;
+    }
+
+    if (status == STATUS_OK) {
+        if (I2C_OS_SemaphoreTake(&rtosHandle->transferDone, waitMs) != STATUS_OK) {
+            I2Cx_RTOS_Backstop(rtosHandle);
+        }
+        if (rtosHandle->transferError == I2C_ERROR_TIMEOUT) {
+            status = STATUS_TIMEOUT;
+        } else if (rtosHandle->transferError != I2C_ERRROR_NONE) {
+            status = STATUS_ERROR;
+        }
+    }
+
+    I2C_OS_MutexUnlock(&rtosHandle->busLock);
+    return status;
+}
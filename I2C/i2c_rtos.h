@@ -0,0 +1,40 @@
+#ifndef __i2c_rtos_H
+#define __i2c_rtos_H
+
+#include "i2c.h"
+#include "i2c_os.h"
+
+#if !I2C_CONF_IT || !I2C_CONF_CALLBACKS
+#error "i2c_rtos requires I2C_CONF_IT and I2C_CONF_CALLBACKS"
+#endif
+
+/*-------------------------IMPORTANT-------------------------*/
+// Call I2Cx_EV_Handler(&rtosHandle->handle) from the I2Cx event interrupt as usual
+// Keep I2Cx_TimeoutTick running, the OS wait is only a backstop I2C_RTOS_TIMEOUT_MARGIN_MS past the deadline
+// that aborts the transfer from the task, inside I2C_OS_EnterCritical
+// I2Cx_RTOS_Init installs its own callbacks on the handle, don't call I2Cx_AddCallBacks or I2Cx_SetTimeoutCallBack on it afterwards
+/* I2Cx_Transfer blocks the calling task until the interrupt driven transfer completes.
+ * The bus mutex serialises tasks sharing the same peripheral, the task sleeps on a
+ * binary semaphore given exactly once per transfer, by the STOP driven completion
+ * callback or by the timeout callback.
+ */
+
+
+#ifndef I2C_RTOS_TIMEOUT_MARGIN_MS
+#define I2C_RTOS_TIMEOUT_MARGIN_MS     10
+#endif
+
+typedef struct {
+    I2C_HandleTypeDef handle;   // Must stay the first member, callbacks cast the I2C handle back to this
+    I2C_OS_MutexTypeDef busLock;
+    I2C_OS_SemaphoreTypeDef transferDone;
+    volatile I2C_ErrorTypeDef transferError;
+} I2C_RTOS_HandleTypeDef;
+
+
+/* Global functions */
+StatusTypeDef I2Cx_RTOS_Init(I2C_RTOS_HandleTypeDef *rtosHandle, I2C_TypeDef *instance);
+StatusTypeDef I2Cx_Transfer(I2C_RTOS_HandleTypeDef *rtosHandle, I2C_OperationTypeDef operation, uint8_t devAddress, uint16_t memAddress, uint8_t memSize, uint8_t *data, uint16_t dataSize, uint32_t timeoutUs);
+
+
+#endif
@@ -0,0 +1,19 @@
+#include "i2c_trace.h"
+
+#if I2C_CONF_TRACE
+
+I2C_TraceRingTypeDef I2C_Trace_Ring = {
+    .magic    = I2C_TRACE_MAGIC,
+    .version  = I2C_TRACE_VERSION,
+    .capacity = I2C_TRACE_SIZE,
+    .head     = 0,
+};
+
+/**
+  * @brief Discards recorded events, call while no I2C transfer is in progress
+  */
+void I2C_Trace_Reset(void) {
+    I2C_Trace_Ring.head = 0;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef __i2c_trace_H
+#define __i2c_trace_H
+
+#include <stdint.h>
+#include "i2c_conf.h"
+
+
+/*-------------------------IMPORTANT-------------------------*/
+// Build with I2C_CONF_TRACE=1 and link i2c_trace.c, with tracing off every I2C_TRACE() compiles away
+// Timestamps default to DWT->CYCCNT, enable it first (I2C_Clock_DWT_Init does) or define I2C_TRACE_TIMESTAMP()
+// Dump I2C_Trace_Ring as raw memory and convert it with tools/i2c_trace2json.py for chrome://tracing or Perfetto
+//   gdb: dump binary memory trace.bin &I2C_Trace_Ring ((char *)&I2C_Trace_Ring + sizeof(I2C_Trace_Ring))
+/* Recording is lock-free and safe from any interrupt: a slot is claimed with an atomic
+ * increment (LDREX/STREX, PRIMASK on ARMv6-M) and then filled. The bus id is bits 10-13
+ * of the peripheral base address, I2C1/I2C2/I2C3 are 5/6/7 on most STM32 parts.
+ */
+
+
+#define I2C_TRACE_MAGIC                ((uint32_t)0x54433249)   // "I2CT"
+#define I2C_TRACE_VERSION              1
+
+typedef enum {
+    I2C_TRACE_SUBMIT   = 0x01,  // arg: I2C_OperationTypeDef, data: dataSize
+    I2C_TRACE_START    = 0x02,  // arg: devAddress, data: NBYTES | 0x8000 for reads
+    I2C_TRACE_ISR      = 0x03,  // data: ISR flag being serviced
+    I2C_TRACE_STATE    = 0x04,  // arg: new I2C_StateTypeDef, data: previous state
+    I2C_TRACE_NACK     = 0x05,
+    I2C_TRACE_STOP     = 0x06,
+    I2C_TRACE_CALLBACK = 0x07,  // arg: I2C_CallBackTypeDef
+    I2C_TRACE_TIMEOUT  = 0x08,  // arg: state the transfer was stuck in
+} I2C_TraceEventTypeDef;
+
+typedef struct {
+    uint32_t timestamp;
+    uint8_t event;              // Low nibble I2C_TraceEventTypeDef, high nibble bus id
+    uint8_t arg;
+    uint16_t data;
+} I2C_TraceRecordTypeDef;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t capacity;
+    volatile uint32_t head;     // Events recorded since start, the slot is head % capacity
+    uint32_t reserved;
+    I2C_TraceRecordTypeDef records[I2C_TRACE_SIZE];
+} I2C_TraceRingTypeDef;
+
+
+#if I2C_CONF_TRACE
+
+#if (I2C_TRACE_SIZE & (I2C_TRACE_SIZE - 1)) != 0
+#error "I2C_TRACE_SIZE must be a power of two"
+#endif
+
+#ifndef I2C_TRACE_TIMESTAMP
+#define I2C_TRACE_TIMESTAMP()          (DWT->CYCCNT)
+#endif
+
+extern I2C_TraceRingTypeDef I2C_Trace_Ring;
+
+void I2C_Trace_Reset(void);
+
+static inline void I2C_Trace_Record(const void *instance, I2C_TraceEventTypeDef event, uint8_t arg, uint16_t data) {
+    uint32_t slot;
+
+#if defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_8M_BASE__)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    slot = I2C_Trace_Ring.head++;
+    __set_PRIMASK(primask);
+#else
+    slot = __atomic_fetch_add(&I2C_Trace_Ring.head, 1, __ATOMIC_RELAXED);
+#endif
+
+    I2C_TraceRecordTypeDef *record = &I2C_Trace_Ring.records[slot & (I2C_TRACE_SIZE - 1)];
+    record->timestamp = I2C_TRACE_TIMESTAMP();
+    record->event = (uint8_t)(event | ((((uintptr_t)instance >> 10) & 0xF) << 4));
+    record->arg = arg;
+    record->data = data;
+}
+
+#define I2C_TRACE(instance, event, arg, data)   I2C_Trace_Record((instance), (event), (uint8_t)(arg), (uint16_t)(data))
+
+#else
+
+#define I2C_TRACE(instance, event, arg, data)   do { } while (0)
+
+#endif
+
+
+#endif
@@ -0,0 +1,38 @@
+#include "i2c_clock.h"
+#include "commons.h"
+
+/*-------------------------IMPORTANT-------------------------*/
+// Import the correct STM32 CMSIS header for your device (Cortex-M3 and up, M0 parts have no DWT, use the SysTick port)
+// Call I2C_Clock_DWT_Init once SystemCoreClock is final, then I2C_Clock_SetSource(I2C_Clock_DWT_NowUs)
+// The source must be read at least once per CYCCNT wrap (2^32 core cycles, ~25s at 168MHz)
+
+static uint32_t I2C_Clock_DWT_CyclesPerUs;
+static uint32_t I2C_Clock_DWT_LastCycles;
+static uint32_t I2C_Clock_DWT_Us;
+
+void I2C_Clock_DWT_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    I2C_Clock_DWT_CyclesPerUs = SystemCoreClock / 1000000;
+    I2C_Clock_DWT_LastCycles = 0;
+    I2C_Clock_DWT_Us = 0;
+}
+
+/**
+  * @brief Extends the 32-bit cycle counter into a microsecond counter that wraps at 2^32 us
+  */
+uint32_t I2C_Clock_DWT_NowUs(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t elapsedUs = (DWT->CYCCNT - I2C_Clock_DWT_LastCycles) / I2C_Clock_DWT_CyclesPerUs;
+    // Only consume whole microseconds so the remainder carries into the next read
+    I2C_Clock_DWT_LastCycles += elapsedUs * I2C_Clock_DWT_CyclesPerUs;
+    I2C_Clock_DWT_Us += elapsedUs;
+    uint32_t nowUs = I2C_Clock_DWT_Us;
+
+    __set_PRIMASK(primask);
+    return nowUs;
+}
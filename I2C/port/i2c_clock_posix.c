@@ -0,0 +1,13 @@
+// clock_gettime and CLOCK_MONOTONIC are POSIX, not ISO C
+#define _POSIX_C_SOURCE 200809L
+
+#include "i2c_clock.h"
+#include <time.h>
+
+// Register with I2C_Clock_SetSource(I2C_Clock_POSIX_NowUs) when running on a host
+
+uint32_t I2C_Clock_POSIX_NowUs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000);
+}
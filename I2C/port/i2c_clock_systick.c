@@ -0,0 +1,41 @@
+#include "i2c_clock.h"
+#include "commons.h"
+
+/*-------------------------IMPORTANT-------------------------*/
+// Import the correct STM32 CMSIS header for your device
+// Configure SysTick for a 1ms period and call I2C_Clock_SysTick_Handler from SysTick_Handler
+// Then register the source with I2C_Clock_SetSource(I2C_Clock_SysTick_NowUs)
+
+static volatile uint32_t I2C_Clock_SysTick_Ms;
+
+void I2C_Clock_SysTick_Handler(void) {
+    I2C_Clock_SysTick_Ms++;
+}
+
+/**
+  * @brief Milliseconds from the tick counter plus the sub-millisecond part from SysTick->VAL
+  */
+uint32_t I2C_Clock_SysTick_NowUs(void) {
+    uint32_t ms;
+    uint32_t before;
+    uint32_t val;
+    uint32_t reloadPending;
+
+    // Re-read if the tick interrupt ran in between, so ms and VAL belong to the same period
+    do {
+        ms = I2C_Clock_SysTick_Ms;
+        before = SysTick->VAL;
+        reloadPending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+        val = SysTick->VAL;
+    } while (ms != I2C_Clock_SysTick_Ms);
+
+    // Called at or above SysTick priority the counter can reload while its interrupt is still pending,
+    // VAL then already belongs to the next period. VAL counting up catches a reload after the pending
+    // check. COUNTFLAG isn't used since reading it clears it for every other user of SysTick.
+    if (reloadPending || val > before) {
+        ms++;
+    }
+
+    uint32_t load = SysTick->LOAD + 1;
+    return ms * 1000 + ((load - 1 - val) * 1000) / load;
+}
@@ -0,0 +1,65 @@
+#include "i2c_os.h"
+
+#if defined(I2C_OS_FREERTOS)
+
+/**
+  * @brief Converts a millisecond timeout to FreeRTOS ticks, short waits never become zero
+  */
+static TickType_t I2C_OS_ToTicks(uint32_t timeoutMs) {
+    if (timeoutMs == I2C_OS_WAIT_FOREVER) {
+        return portMAX_DELAY;
+    }
+    // portTICK_PERIOD_MS is 0 above 1 kHz tick rates, pdMS_TO_TICKS works at any rate
+    TickType_t ticks = pdMS_TO_TICKS(timeoutMs);
+    return (ticks == 0 && timeoutMs != 0) ? 1 : ticks;
+}
+
+StatusTypeDef I2C_OS_MutexCreate(I2C_OS_MutexTypeDef *mutex) {
+    mutex->handle = xSemaphoreCreateMutexStatic(&mutex->buffer);
+    return (mutex->handle != NULL) ? STATUS_OK : STATUS_ERROR;
+}
+
+StatusTypeDef I2C_OS_MutexLock(I2C_OS_MutexTypeDef *mutex, uint32_t timeoutMs) {
+    if (xSemaphoreTake(mutex->handle, I2C_OS_ToTicks(timeoutMs)) != pdTRUE) {
+        return STATUS_TIMEOUT;
+    }
+    return STATUS_OK;
+}
+
+void I2C_OS_MutexUnlock(I2C_OS_MutexTypeDef *mutex) {
+    xSemaphoreGive(mutex->handle);
+}
+
+StatusTypeDef I2C_OS_SemaphoreCreate(I2C_OS_SemaphoreTypeDef *semaphore) {
+    semaphore->handle = xSemaphoreCreateBinaryStatic(&semaphore->buffer);
+    return (semaphore->handle != NULL) ? STATUS_OK : STATUS_ERROR;
+}
+
+StatusTypeDef I2C_OS_SemaphoreTake(I2C_OS_SemaphoreTypeDef *semaphore, uint32_t timeoutMs) {
+    if (xSemaphoreTake(semaphore->handle, I2C_OS_ToTicks(timeoutMs)) != pdTRUE) {
+        return STATUS_TIMEOUT;
+    }
+    return STATUS_OK;
+}
+
+/**
+  * @brief Signals the semaphore from the I2C event interrupt and yields if a higher priority task was woken
+  */
+void I2C_OS_SemaphoreGiveFromISR(I2C_OS_SemaphoreTypeDef *semaphore) {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(semaphore->handle, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+/**
+  * @brief Masks interrupts up to configMAX_SYSCALL_INTERRUPT_PRIORITY, which covers the I2C event interrupt
+  */
+void I2C_OS_EnterCritical(void) {
+    taskENTER_CRITICAL();
+}
+
+void I2C_OS_ExitCritical(void) {
+    taskEXIT_CRITICAL();
+}
+
+#endif
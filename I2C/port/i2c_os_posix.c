@@ -0,0 +1,135 @@
+// clock_gettime, CLOCK_MONOTONIC and pthread_mutex_timedlock are POSIX, not ISO C
+#define _POSIX_C_SOURCE 200809L
+
+#include "i2c_os.h"
+
+#if defined(I2C_OS_POSIX)
+
+#include <errno.h>
+#include <time.h>
+
+#define I2C_OS_MAX_DEFERRED           4
+
+static pthread_mutex_t I2C_OS_CriticalLock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local uint8_t I2C_OS_InCritical;
+static _Thread_local uint8_t I2C_OS_NumDeferred;
+static _Thread_local I2C_OS_SemaphoreTypeDef *I2C_OS_Deferred[I2C_OS_MAX_DEFERRED];
+
+static void I2C_OS_SemaphoreGive(I2C_OS_SemaphoreTypeDef *semaphore) {
+    pthread_mutex_lock(&semaphore->lock);
+    semaphore->given = 1;
+    pthread_cond_signal(&semaphore->cond);
+    pthread_mutex_unlock(&semaphore->lock);
+}
+
+/**
+  * @brief Builds an absolute deadline on the given clock, timeoutMs from now
+  */
+static void I2C_OS_Deadline(clockid_t clock, uint32_t timeoutMs, struct timespec *deadline) {
+    clock_gettime(clock, deadline);
+    deadline->tv_sec += timeoutMs / 1000;
+    deadline->tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+StatusTypeDef I2C_OS_MutexCreate(I2C_OS_MutexTypeDef *mutex) {
+    return (pthread_mutex_init(&mutex->lock, NULL) == 0) ? STATUS_OK : STATUS_ERROR;
+}
+
+StatusTypeDef I2C_OS_MutexLock(I2C_OS_MutexTypeDef *mutex, uint32_t timeoutMs) {
+    if (timeoutMs == I2C_OS_WAIT_FOREVER) {
+        return (pthread_mutex_lock(&mutex->lock) == 0) ? STATUS_OK : STATUS_ERROR;
+    }
+
+    // pthread_mutex_timedlock only accepts CLOCK_REALTIME deadlines
+    struct timespec deadline;
+    I2C_OS_Deadline(CLOCK_REALTIME, timeoutMs, &deadline);
+    int result = pthread_mutex_timedlock(&mutex->lock, &deadline);
+    if (result == ETIMEDOUT) {
+        return STATUS_TIMEOUT;
+    }
+    return (result == 0) ? STATUS_OK : STATUS_ERROR;
+}
+
+void I2C_OS_MutexUnlock(I2C_OS_MutexTypeDef *mutex) {
+    pthread_mutex_unlock(&mutex->lock);
+}
+
+StatusTypeDef I2C_OS_SemaphoreCreate(I2C_OS_SemaphoreTypeDef *semaphore) {
+    pthread_condattr_t attr;
+
+    if (pthread_mutex_init(&semaphore->lock, NULL) != 0) {
+        return STATUS_ERROR;
+    }
+
+    // Wait on the monotonic clock so wall clock adjustments can't stretch a transfer timeout
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int result = pthread_cond_init(&semaphore->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    semaphore->given = 0;
+    return (result == 0) ? STATUS_OK : STATUS_ERROR;
+}
+
+StatusTypeDef I2C_OS_SemaphoreTake(I2C_OS_SemaphoreTypeDef *semaphore, uint32_t timeoutMs) {
+    StatusTypeDef status = STATUS_OK;
+    struct timespec deadline;
+
+    if (timeoutMs != I2C_OS_WAIT_FOREVER) {
+        I2C_OS_Deadline(CLOCK_MONOTONIC, timeoutMs, &deadline);
+    }
+
+    pthread_mutex_lock(&semaphore->lock);
+    while (!semaphore->given) {
+        if (timeoutMs == I2C_OS_WAIT_FOREVER) {
+            pthread_cond_wait(&semaphore->cond, &semaphore->lock);
+        } else if (pthread_cond_timedwait(&semaphore->cond, &semaphore->lock, &deadline) == ETIMEDOUT) {
+            status = STATUS_TIMEOUT;
+            break;
+        }
+    }
+    if (status == STATUS_OK) {
+        semaphore->given = 0;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+
+    return status;
+}
+
+/**
+  * @brief Signals the semaphore, on POSIX the "interrupt" is whichever thread simulates the I2C peripheral.
+  *        Inside the critical section the give waits for I2C_OS_ExitCritical, so like after
+  *        portYIELD_FROM_ISR the woken task only runs once the handler has returned.
+  */
+void I2C_OS_SemaphoreGiveFromISR(I2C_OS_SemaphoreTypeDef *semaphore) {
+    if (I2C_OS_InCritical && I2C_OS_NumDeferred < I2C_OS_MAX_DEFERRED) {
+        I2C_OS_Deferred[I2C_OS_NumDeferred++] = semaphore;
+        return;
+    }
+    I2C_OS_SemaphoreGive(semaphore);
+}
+
+/**
+  * @brief Stands in for masking the I2C interrupt, the simulating thread takes the same lock
+  */
+void I2C_OS_EnterCritical(void) {
+    pthread_mutex_lock(&I2C_OS_CriticalLock);
+    I2C_OS_InCritical = 1;
+}
+
+void I2C_OS_ExitCritical(void) {
+    uint8_t numDeferred = I2C_OS_NumDeferred;
+
+    I2C_OS_InCritical = 0;
+    I2C_OS_NumDeferred = 0;
+    pthread_mutex_unlock(&I2C_OS_CriticalLock);
+    for (uint8_t i = 0; i < numDeferred; i++) {
+        I2C_OS_SemaphoreGive(I2C_OS_Deferred[i]);
+    }
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef __check_H
+#define __check_H
+
+#include <stdarg.h>
+#include <stdio.h>
+
+/*-------------------------IMPORTANT-------------------------*/
+// Assertion helpers shared by the tests/host tests, C and C++
+// check may be called from several threads, only the first CHECK_MAX_REPORTED failures are printed
+// End main with return checkSummary(...), it prints the summary line with the failure count
+
+#define CHECK_MAX_REPORTED             10
+
+static int checkFailures;
+
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+static inline void check(int ok, const char *format, ...) {
+    if (ok) {
+        return;
+    }
+    if (__atomic_fetch_add(&checkFailures, 1, __ATOMIC_RELAXED) < CHECK_MAX_REPORTED) {
+        va_list args;
+        va_start(args, format);
+        printf("FAIL ");
+        vprintf(format, args);
+        printf("\n");
+        va_end(args);
+    }
+}
+
+/**
+  * @brief Prints "<summary>, N failures" and returns the exit code of the test
+  */
+#if defined(__GNUC__)
+__attribute__((format(printf, 1, 2)))
+#endif
+static inline int checkSummary(const char *format, ...) {
+    va_list args;
+    int failures = __atomic_load_n(&checkFailures, __ATOMIC_RELAXED);
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf(", %d failures\n", failures);
+    return failures ? 1 : 0;
+}
+
+#endif
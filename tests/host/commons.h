@@ -0,0 +1,93 @@
+#ifndef __commons_H
+#define __commons_H
+
+// This header is force-included ahead of the sources' own feature macros, select the same POSIX level here
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*-------------------------IMPORTANT-------------------------*/
+// Host stand-in for the project commons.h and the CMSIS device header, only used by tests/host
+// I2C_TypeDef is plain memory here, i2c_sim.c plays the peripheral behind it
+
+
+typedef enum {
+    STATUS_OK      = 0x00,
+    STATUS_ERROR   = 0x01,
+    STATUS_BUSY    = 0x02,
+    STATUS_TIMEOUT = 0x03
+} StatusTypeDef;
+
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t OAR1;
+    volatile uint32_t OAR2;
+    volatile uint32_t TIMINGR;
+    volatile uint32_t TIMEOUTR;
+    volatile uint32_t ISR;
+    volatile uint32_t ICR;
+    volatile uint32_t PECR;
+    volatile uint32_t RXDR;
+    volatile uint32_t TXDR;
+} I2C_TypeDef;
+
+#define I2C_CR1_PE                     (1U << 0)
+#define I2C_CR1_TXIE                   (1U << 1)
+#define I2C_CR1_RXIE                   (1U << 2)
+#define I2C_CR1_NACKIE                 (1U << 4)
+#define I2C_CR1_STOPIE                 (1U << 5)
+#define I2C_CR1_TCIE                   (1U << 6)
+
+#define I2C_CR2_SADD                   (0x3FFU)
+#define I2C_CR2_RD_WRN                 (1U << 10)
+#define I2C_CR2_START                  (1U << 13)
+#define I2C_CR2_STOP                   (1U << 14)
+#define I2C_CR2_NBYTES_Pos             16
+#define I2C_CR2_NBYTES                 (0xFFU << I2C_CR2_NBYTES_Pos)
+#define I2C_CR2_RELOAD                 (1U << 24)
+#define I2C_CR2_AUTOEND                (1U << 25)
+
+#define I2C_ISR_TXIS                   (1U << 1)
+#define I2C_ISR_RXNE                   (1U << 2)
+#define I2C_ISR_NACKF                  (1U << 4)
+#define I2C_ISR_STOPF                  (1U << 5)
+#define I2C_ISR_TC                     (1U << 6)
+#define I2C_ISR_TCR                    (1U << 7)
+#define I2C_ISR_BUSY                   (1U << 15)
+
+#define I2C_ICR_NACKCF                 (1U << 4)
+#define I2C_ICR_STOPCF                 (1U << 5)
+
+/* Cortex-M core registers used by the clock ports, tests set them directly */
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t LOAD;
+    volatile uint32_t VAL;
+    volatile uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+    volatile uint32_t CPUID;
+    volatile uint32_t ICSR;
+} SCB_Type;
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+extern SysTick_Type Host_SysTick;
+extern SCB_Type Host_SCB;
+extern DWT_Type Host_DWT;
+
+#define SysTick                        (&Host_SysTick)
+#define SCB                            (&Host_SCB)
+#define DWT                            (&Host_DWT)
+#define SCB_ICSR_PENDSTSET_Msk         (1U << 26)
+
+
+#endif
@@ -0,0 +1,79 @@
+#include "eeprom24xx_model.h"
+#include <string.h>
+
+static uint8_t EEPROM24_Model_Select(I2C_SimDeviceTypeDef *device, uint8_t read) {
+    EEPROM24_ModelTypeDef *model = (EEPROM24_ModelTypeDef *)device;
+
+    // No ACK while the internal write cycle runs
+    if (I2C_Sim_TimeNs < model->busyUntilNs) {
+        model->busyNacks++;
+        return 0;
+    }
+    // A read continues at the pointer, a write starts with the sub-address
+    if (!read) {
+        model->addressBytes = 0;
+        model->received = 0;
+    }
+    return 1;
+}
+
+static uint8_t EEPROM24_Model_Write(I2C_SimDeviceTypeDef *device, uint8_t byte) {
+    EEPROM24_ModelTypeDef *model = (EEPROM24_ModelTypeDef *)device;
+
+    if (model->addressBytes < model->addressSize) {
+        model->pointer = (model->pointer << 8) | byte;
+        if (++model->addressBytes == model->addressSize) {
+            model->pointer &= model->capacity - 1;
+        }
+        return 1;
+    }
+    // The page address counter wraps, bytes past the page end overwrite its start
+    model->latch[(model->pointer + model->received) & (model->pageSize - 1U)] = byte;
+    model->received++;
+    return 1;
+}
+
+static uint8_t EEPROM24_Model_Read(I2C_SimDeviceTypeDef *device) {
+    EEPROM24_ModelTypeDef *model = (EEPROM24_ModelTypeDef *)device;
+    uint8_t byte = model->memory[model->pointer];
+
+    model->pointer = (model->pointer + 1) & (model->capacity - 1);
+    return byte;
+}
+
+static void EEPROM24_Model_Stop(I2C_SimDeviceTypeDef *device) {
+    EEPROM24_ModelTypeDef *model = (EEPROM24_ModelTypeDef *)device;
+    uint32_t mask = model->pageSize - 1U;
+    uint32_t page = model->pointer & ~mask;
+
+    if (model->received == 0) {
+        return;
+    }
+
+    // Only the last pageSize bytes survive in the latch
+    uint32_t kept = model->received < model->pageSize ? model->received : model->pageSize;
+    uint32_t first = model->pointer + model->received - kept;
+    for (uint32_t i = 0; i < kept; i++) {
+        uint32_t offset = (first + i) & mask;
+        model->memory[page + offset] = model->latch[offset];
+    }
+    model->pointer = page + ((model->pointer + model->received) & mask);
+    model->received = 0;
+    model->pageWrites++;
+    model->busyUntilNs = I2C_Sim_TimeNs + (uint64_t)model->writeCycleUs * 1000;
+}
+
+void EEPROM24_Model_Init(EEPROM24_ModelTypeDef *model, uint8_t address, uint32_t capacity, uint16_t pageSize, uint8_t addressSize, uint32_t writeCycleUs) {
+    memset(model, 0, sizeof(*model));
+    // Erased cells read back as 0xFF
+    memset(model->memory, 0xFF, sizeof(model->memory));
+    model->device.address = address;
+    model->device.select = EEPROM24_Model_Select;
+    model->device.write = EEPROM24_Model_Write;
+    model->device.read = EEPROM24_Model_Read;
+    model->device.stop = EEPROM24_Model_Stop;
+    model->capacity = capacity;
+    model->pageSize = pageSize;
+    model->addressSize = addressSize;
+    model->writeCycleUs = writeCycleUs;
+}
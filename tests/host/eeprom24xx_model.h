@@ -0,0 +1,34 @@
+#ifndef __eeprom24xx_model_H
+#define __eeprom24xx_model_H
+
+#include "i2c_sim.h"
+
+/*-------------------------IMPORTANT-------------------------*/
+// Host model of a 24xx EEPROM for I2C_Sim, for tests/host only
+/* Writes latch into a page buffer that wraps inside the page, the STOP after the data starts the
+ * internal write cycle. For writeCycleUs of bus time the part NACKs its address, which is what ACK
+ * polling waits for. Reads stream from the address pointer and wrap at the end of the array.
+ */
+
+#define EEPROM24_MODEL_CAPACITY        32768
+#define EEPROM24_MODEL_MAX_PAGE        256
+
+typedef struct {
+    I2C_SimDeviceTypeDef device;    // Must stay the first member
+    uint8_t memory[EEPROM24_MODEL_CAPACITY];
+    uint8_t latch[EEPROM24_MODEL_MAX_PAGE];
+    uint32_t capacity;
+    uint16_t pageSize;
+    uint8_t addressSize;
+    uint32_t writeCycleUs;
+    uint64_t busyUntilNs;
+    uint32_t pointer;
+    uint8_t addressBytes;           // Sub-address bytes received since the START
+    uint32_t received;              // Data bytes received since the sub-address
+    uint32_t pageWrites;
+    uint32_t busyNacks;
+} EEPROM24_ModelTypeDef;
+
+void EEPROM24_Model_Init(EEPROM24_ModelTypeDef *model, uint8_t address, uint32_t capacity, uint16_t pageSize, uint8_t addressSize, uint32_t writeCycleUs);
+
+#endif
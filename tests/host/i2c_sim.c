@@ -0,0 +1,261 @@
+#include "i2c_sim.h"
+#include <string.h>
+
+#define I2C_SIM_TXDR_EMPTY             ((uint32_t)0x100)    // Out of byte range, the handler never writes it
+#define I2C_SIM_FLAGS                  (I2C_ISR_TXIS | I2C_ISR_RXNE | I2C_ISR_NACKF | I2C_ISR_STOPF | I2C_ISR_TC | I2C_ISR_TCR)
+
+volatile uint64_t I2C_Sim_TimeNs;
+
+static void I2C_Sim_Clock(I2C_SimTypeDef *sim, uint32_t bits) {
+    I2C_Sim_TimeNs += (uint64_t)bits * sim->bitTimeNs;
+}
+
+/**
+  * @brief Enabled and pending interrupt flags, what would make the NVIC enter the event handler
+  */
+static uint32_t I2C_Sim_Pending(const I2C_SimTypeDef *sim) {
+    uint32_t isr = sim->regs.ISR;
+    uint32_t cr1 = sim->regs.CR1;
+    uint32_t pending = 0;
+
+    if ((isr & I2C_ISR_TXIS) && (cr1 & I2C_CR1_TXIE)) pending |= I2C_ISR_TXIS;
+    if ((isr & I2C_ISR_RXNE) && (cr1 & I2C_CR1_RXIE)) pending |= I2C_ISR_RXNE;
+    if ((isr & I2C_ISR_NACKF) && (cr1 & I2C_CR1_NACKIE)) pending |= I2C_ISR_NACKF;
+    if ((isr & I2C_ISR_STOPF) && (cr1 & I2C_CR1_STOPIE)) pending |= I2C_ISR_STOPF;
+    if ((isr & (I2C_ISR_TC | I2C_ISR_TCR)) && (cr1 & I2C_CR1_TCIE)) pending |= isr & (I2C_ISR_TC | I2C_ISR_TCR);
+    return pending;
+}
+
+static void I2C_Sim_Nack(I2C_SimTypeDef *sim) {
+    sim->regs.ISR |= I2C_ISR_NACKF;
+    sim->stopPending = 1;
+}
+
+/**
+  * @brief START or repeated START: latches CR2 and runs the address phase
+  */
+static void I2C_Sim_Start(I2C_SimTypeDef *sim) {
+    uint32_t cr2 = sim->regs.CR2;
+    uint8_t address = (uint8_t)((cr2 & I2C_CR2_SADD) >> 1);
+
+    sim->regs.CR2 = cr2 & ~I2C_CR2_START;
+    sim->regs.ISR = (sim->regs.ISR & ~(I2C_ISR_TC | I2C_ISR_TCR)) | I2C_ISR_BUSY;
+    sim->active = 1;
+    sim->stopPending = 0;
+    sim->reading = (cr2 & I2C_CR2_RD_WRN) ? 1 : 0;
+    sim->remaining = (cr2 & I2C_CR2_NBYTES) >> I2C_CR2_NBYTES_Pos;
+
+    sim->selected = NULL;
+    for (uint8_t i = 0; i < sim->numDevices; i++) {
+        if (sim->devices[i]->address == address) {
+            sim->selected = sim->devices[i];
+        }
+    }
+
+    // START, 7 address bits, R/W and the ACK slot
+    I2C_Sim_Clock(sim, 10);
+    if (sim->selected == NULL || !sim->selected->select(sim->selected, sim->reading)) {
+        I2C_Sim_Nack(sim);
+    }
+}
+
+static void I2C_Sim_Stop(I2C_SimTypeDef *sim) {
+    I2C_Sim_Clock(sim, 1);
+    sim->regs.ISR = (sim->regs.ISR & ~(I2C_ISR_BUSY | I2C_ISR_TC | I2C_ISR_TCR)) | I2C_ISR_STOPF;
+    sim->active = 0;
+    sim->stopPending = 0;
+    if (sim->selected != NULL) {
+        sim->selected->stop(sim->selected);
+        sim->selected = NULL;
+    }
+}
+
+/**
+  * @brief Raises the next flag of the transfer once every earlier one has been serviced
+  */
+static void I2C_Sim_NextEvent(I2C_SimTypeDef *sim) {
+    uint32_t cr2 = sim->regs.CR2;
+
+    if (sim->regs.ISR & I2C_SIM_FLAGS) {
+        return;
+    }
+    if (sim->stopPending) {
+        I2C_Sim_Stop(sim);
+    } else if (sim->remaining > 0) {
+        if (sim->reading) {
+            sim->regs.RXDR = sim->selected->read(sim->selected);
+            sim->remaining--;
+            I2C_Sim_Clock(sim, 9);
+            sim->regs.ISR |= I2C_ISR_RXNE;
+        } else {
+            sim->regs.TXDR = I2C_SIM_TXDR_EMPTY;
+            sim->regs.ISR |= I2C_ISR_TXIS;
+        }
+    } else if (cr2 & I2C_CR2_RELOAD) {
+        sim->regs.ISR |= I2C_ISR_TCR;
+    } else if (cr2 & I2C_CR2_AUTOEND) {
+        I2C_Sim_Stop(sim);
+    } else {
+        sim->regs.ISR |= I2C_ISR_TC;
+    }
+}
+
+/**
+  * @brief Writing TXDR clears TXIS, the byte then goes out on the bus
+  */
+static void I2C_Sim_Transmit(I2C_SimTypeDef *sim) {
+    sim->regs.ISR &= ~I2C_ISR_TXIS;
+    sim->remaining--;
+    I2C_Sim_Clock(sim, 9);
+    if (sim->selected == NULL || !sim->selected->write(sim->selected, (uint8_t)sim->regs.TXDR)) {
+        I2C_Sim_Nack(sim);
+    }
+}
+
+void I2C_Sim_Init(I2C_SimTypeDef *sim, I2C_HandleTypeDef *handle, uint32_t bitRateHz) {
+    memset(sim, 0, sizeof(*sim));
+    sim->handle = handle;
+    sim->bitTimeNs = 1000000000U / bitRateHz;
+    sim->regs.CR1 = I2C_CR1_PE;
+}
+
+void I2C_Sim_Attach(I2C_SimTypeDef *sim, I2C_SimDeviceTypeDef *device) {
+    if (sim->numDevices < I2C_SIM_MAX_DEVICES) {
+        sim->devices[sim->numDevices++] = device;
+    }
+}
+
+/**
+  * @brief Advances the bus by one event and services it like the event interrupt would
+  * @retval 1 while a transfer is in progress or a flag is pending, 0 when the bus is idle
+  */
+uint8_t I2C_Sim_Step(I2C_SimTypeDef *sim) {
+    I2C_TypeDef *regs = &sim->regs;
+
+    if (sim->frozen) {
+        return 1;
+    }
+
+    // PE cleared by a software reset drops the transfer and every flag
+    if (!(regs->CR1 & I2C_CR1_PE)) {
+        regs->ISR = 0;
+        sim->active = 0;
+        sim->selected = NULL;
+        return 0;
+    }
+
+    // Flags a polling driver cleared since the last step, it may write ICR from another thread meanwhile
+    uint32_t icr = __atomic_exchange_n(&regs->ICR, 0, __ATOMIC_SEQ_CST);
+    regs->ISR &= ~(icr & (I2C_ISR_NACKF | I2C_ISR_STOPF));
+
+    if (regs->CR2 & I2C_CR2_START) {
+        I2C_Sim_Start(sim);
+    } else if (!sim->active && !(regs->ISR & I2C_SIM_FLAGS)) {
+        return 0;
+    }
+    if (sim->active) {
+        I2C_Sim_NextEvent(sim);
+    }
+
+    uint32_t pending = I2C_Sim_Pending(sim);
+    if (!pending) {
+        // A polling driver writes TXDR without the interrupt
+        if ((regs->ISR & I2C_ISR_TXIS) && regs->TXDR != I2C_SIM_TXDR_EMPTY) {
+            I2C_Sim_Transmit(sim);
+        }
+        return 1;
+    }
+
+    I2Cx_EV_Handler(sim->handle);
+
+    if ((pending & I2C_ISR_TXIS) && regs->TXDR != I2C_SIM_TXDR_EMPTY) {
+        I2C_Sim_Transmit(sim);
+    }
+    if (pending & I2C_ISR_RXNE) {
+        regs->ISR &= ~I2C_ISR_RXNE;
+    }
+    if ((pending & I2C_ISR_TCR) && !(regs->CR2 & I2C_CR2_START)) {
+        // Writing NBYTES clears TCR and continues the transfer
+        regs->ISR &= ~I2C_ISR_TCR;
+        sim->remaining = (regs->CR2 & I2C_CR2_NBYTES) >> I2C_CR2_NBYTES_Pos;
+    }
+    regs->ISR &= ~(regs->ICR & (I2C_ISR_NACKF | I2C_ISR_STOPF));
+    return 1;
+}
+
+/**
+  * @brief Steps until the bus is idle
+  * @retval 0 if the bus was still busy after maxSteps
+  */
+uint8_t I2C_Sim_RunUntilIdle(I2C_SimTypeDef *sim, uint32_t maxSteps) {
+    while (maxSteps--) {
+        if (!I2C_Sim_Step(sim)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+  * @brief Models the software reset of I2Cx_Abort, the driver's PE toggle can't be observed on plain memory
+  */
+void I2C_Sim_Reset(I2C_SimTypeDef *sim) {
+    // PE cleared also drops a START or STOP request that never made it onto a stalled bus
+    sim->regs.CR2 &= ~(I2C_CR2_START | I2C_CR2_STOP);
+    sim->regs.ISR = 0;
+    sim->regs.ICR = 0;
+    sim->active = 0;
+    sim->stopPending = 0;
+    sim->selected = NULL;
+    sim->frozen = 0;
+}
+
+void I2C_Sim_Advance(uint32_t us) {
+    I2C_Sim_TimeNs += (uint64_t)us * 1000;
+}
+
+uint32_t I2C_Sim_NowUs(void) {
+    return (uint32_t)(I2C_Sim_TimeNs / 1000);
+}
+
+
+static uint8_t I2C_Sim_RegSelect(I2C_SimDeviceTypeDef *device, uint8_t read) {
+    I2C_SimRegDeviceTypeDef *regDevice = (I2C_SimRegDeviceTypeDef *)device;
+
+    // A repeated START keeps the pointer, a fresh write starts with the sub-address
+    regDevice->addressed = read;
+    return 1;
+}
+
+static uint8_t I2C_Sim_RegWrite(I2C_SimDeviceTypeDef *device, uint8_t byte) {
+    I2C_SimRegDeviceTypeDef *regDevice = (I2C_SimRegDeviceTypeDef *)device;
+
+    if (!regDevice->addressed) {
+        regDevice->pointer = byte;
+        regDevice->addressed = 1;
+    } else {
+        regDevice->regs[regDevice->pointer++] = byte;
+        regDevice->writes++;
+    }
+    return 1;
+}
+
+static uint8_t I2C_Sim_RegRead(I2C_SimDeviceTypeDef *device) {
+    I2C_SimRegDeviceTypeDef *regDevice = (I2C_SimRegDeviceTypeDef *)device;
+
+    regDevice->reads++;
+    return regDevice->regs[regDevice->pointer++];
+}
+
+static void I2C_Sim_RegStop(I2C_SimDeviceTypeDef *device) {
+    ((I2C_SimRegDeviceTypeDef *)device)->addressed = 0;
+}
+
+void I2C_Sim_RegDeviceInit(I2C_SimRegDeviceTypeDef *regDevice, uint8_t address) {
+    memset(regDevice, 0, sizeof(*regDevice));
+    regDevice->device.address = address;
+    regDevice->device.select = I2C_Sim_RegSelect;
+    regDevice->device.write = I2C_Sim_RegWrite;
+    regDevice->device.read = I2C_Sim_RegRead;
+    regDevice->device.stop = I2C_Sim_RegStop;
+}
@@ -0,0 +1,70 @@
+#ifndef __i2c_sim_H
+#define __i2c_sim_H
+
+#include "i2c.h"
+
+/*-------------------------IMPORTANT-------------------------*/
+// Host model of the STM32 I2C v2 master behind an I2C_TypeDef, for tests/host only
+// Init the driver handle on &sim->regs, then call I2C_Sim_Step wherever the I2Cx event interrupt would run
+/* Each step advances the bus by one event (address, byte, reload, STOP) and calls I2Cx_EV_Handler
+ * while an enabled flag is set. A NACK is followed by an automatic STOP like on the real peripheral.
+ * Bus time is counted at the configured bit rate into I2C_Sim_TimeNs, which I2C_Sim_NowUs exposes
+ * as an I2C clock source so deadlines follow the simulated bus instead of the host.
+ * Polling drivers work too when something steps the model while they spin, e.g. their clock source.
+ * Plain memory can't see the TXDR write or RXDR read that clears TXIS or RXNE before the next step,
+ * so a polling transfer only moves its first data byte correctly.
+ */
+
+
+#define I2C_SIM_MAX_DEVICES            4
+
+typedef struct I2C_SimDeviceStruct I2C_SimDeviceTypeDef;
+
+struct I2C_SimDeviceStruct {
+    uint8_t address;
+    uint8_t (*select)(I2C_SimDeviceTypeDef *device, uint8_t read);   // 1 ACKs the address
+    uint8_t (*write)(I2C_SimDeviceTypeDef *device, uint8_t byte);    // 1 ACKs the byte
+    uint8_t (*read)(I2C_SimDeviceTypeDef *device);
+    void (*stop)(I2C_SimDeviceTypeDef *device);
+};
+
+typedef struct {
+    I2C_TypeDef regs;
+    I2C_HandleTypeDef *handle;
+    I2C_SimDeviceTypeDef *devices[I2C_SIM_MAX_DEVICES];
+    I2C_SimDeviceTypeDef *selected;
+    uint32_t bitTimeNs;
+    uint32_t remaining;         // Bytes left in the current NBYTES chunk
+    uint8_t numDevices;
+    uint8_t active;
+    uint8_t reading;
+    uint8_t stopPending;
+    volatile uint8_t frozen;    // Set to model a device holding SCL low, the bus stops advancing
+} I2C_SimTypeDef;
+
+/* Register file device, 8-bit sub-address that auto-increments */
+typedef struct {
+    I2C_SimDeviceTypeDef device;    // Must stay the first member
+    uint8_t regs[256];
+    uint8_t pointer;
+    uint8_t addressed;
+    uint32_t writes;
+    uint32_t reads;
+} I2C_SimRegDeviceTypeDef;
+
+extern volatile uint64_t I2C_Sim_TimeNs;
+
+
+/* Global functions */
+void I2C_Sim_Init(I2C_SimTypeDef *sim, I2C_HandleTypeDef *handle, uint32_t bitRateHz);
+void I2C_Sim_Attach(I2C_SimTypeDef *sim, I2C_SimDeviceTypeDef *device);
+uint8_t I2C_Sim_Step(I2C_SimTypeDef *sim);
+uint8_t I2C_Sim_RunUntilIdle(I2C_SimTypeDef *sim, uint32_t maxSteps);
+void I2C_Sim_Reset(I2C_SimTypeDef *sim);
+void I2C_Sim_Advance(uint32_t us);
+uint32_t I2C_Sim_NowUs(void);
+
+void I2C_Sim_RegDeviceInit(I2C_SimRegDeviceTypeDef *regDevice, uint8_t address);
+
+
+#endif
@@ -0,0 +1,97 @@
+#!/bin/sh
+# Builds and runs the host tests. The I2C peripheral is modelled by tests/host/i2c_sim.c,
+# tests/host/commons.h stands in for the project header and the CMSIS device header.
+#
+# Usage: tests/host/run_tests.sh [test ...]
+# The size step checks the handle sizes against tests/host/handle_sizes.txt, after an intended change refresh it with
+#   CROSS_COMPILE= I2C_SIZE_CFLAGS="-include tests/host/commons.h" tools/i2c_size_report.sh --handles --update tests/host/handle_sizes.txt
+# With the target toolchain installed it also checks .text against tools/i2c_size_baseline.txt.
+# The trace test runs tools/i2c_trace2json.py on its ring and needs python3.
+#
+# Environment:
+#   CC            host C compiler, default cc
+#   CXX           host C++20 compiler, default c++
+#   HOST_CFLAGS   extra flags for both, e.g. "-fsanitize=thread"
+#   CROSS_COMPILE, I2C_SIZE_CFLAGS  target toolchain for the .text check, see tools/i2c_size_report.sh
+
+set -eu
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+HOST="$ROOT/tests/host"
+CC=${CC:-cc}
+CXX=${CXX:-c++}
+WARN="-Wall -Wextra"
+# i2c.h expects the device header to be included first, as with I2C_SIZE_CFLAGS
+INCLUDES="-include $HOST/commons.h -I$HOST -I$ROOT/I2C"
+CFLAGS="-std=c11 -O2 -g $WARN ${HOST_CFLAGS:-}"
+CXXFLAGS="-std=c++20 -O2 -g $WARN ${HOST_CFLAGS:-}"
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+SELECTED="$*"
+DRIVER="$ROOT/I2C/i2c.c $ROOT/I2C/i2c_clock.c $HOST/i2c_sim.c"
+
+# name|C sources|test main (.c or .cpp)|flags
+TESTS="rtos_contention|$DRIVER $ROOT/I2C/i2c_rtos.c $ROOT/I2C/port/i2c_os_posix.c $ROOT/I2C/port/i2c_clock_posix.c|$HOST/test_rtos_contention.c|-DI2C_OS_POSIX -pthread
+coro|$DRIVER|$HOST/test_coro.cpp|-I$ROOT/HTS221
+clock|$ROOT/I2C/i2c_clock.c $ROOT/I2C/port/i2c_clock_systick.c|$HOST/test_clock.c|
+timeout|$DRIVER|$HOST/test_timeout.c|-DI2C_CONF_STATS=1 -pthread
+handle|$DRIVER|$HOST/test_handle.c|
+handle_mem8|$DRIVER|$HOST/test_handle.c|-DI2C_CONF_MEM_ADDRESS_16BIT=0
+trace|$DRIVER $ROOT/I2C/i2c_trace.c|$HOST/test_trace.c|-DI2C_CONF_TRACE=1 -DTRACE2JSON_TEST=\"$HOST/test_trace2json.py\"
+eeprom24xx|$DRIVER $HOST/eeprom24xx_model.c $ROOT/EEPROM24XX/eeprom24xx.c|$HOST/test_eeprom24xx.c|-I$ROOT/EEPROM24XX
+eeprom24xx_mem8|$DRIVER $HOST/eeprom24xx_model.c $ROOT/EEPROM24XX/eeprom24xx.c|$HOST/test_eeprom24xx.c|-I$ROOT/EEPROM24XX -DI2C_CONF_MEM_ADDRESS_16BIT=0"
+
+selected() {
+    [ -z "$SELECTED" ] && return 0
+    for want in $SELECTED; do
+        [ "$want" = "$1" ] && return 0
+    done
+    return 1
+}
+
+# shellcheck disable=SC2086
+build() {
+    name=$1 sources=$2 main=$3 flags=$4
+    mkdir -p "$WORK/$name"
+    objects=
+    for source in $sources; do
+        object="$WORK/$name/$(basename "$source" .c).o"
+        $CC $CFLAGS $flags $INCLUDES -c "$source" -o "$object" || return 1
+        objects="$objects $object"
+    done
+    case "$main" in
+        *.cpp) $CXX $CXXFLAGS $flags $INCLUDES "$main" $objects -o "$WORK/$name/test" ;;
+        *)     $CC $CFLAGS $flags $INCLUDES "$main" $objects -o "$WORK/$name/test" ;;
+    esac
+}
+
+failed=0
+echo "$TESTS" | {
+    while IFS='|' read -r name sources main flags; do
+        selected "$name" || continue
+        echo "== $name"
+        if ! build "$name" "$sources" "$main" "$flags" || ! "$WORK/$name/test"; then
+            echo "FAILED $name"
+            failed=1
+        fi
+    done
+    # Footprint gate: handle sizes on the host, .text only from the target toolchain against its baseline
+    if selected size; then
+        echo "== size"
+        if ! CROSS_COMPILE= I2C_SIZE_CFLAGS="-include $HOST/commons.h" \
+                "$ROOT/tools/i2c_size_report.sh" --handles --check "$HOST/handle_sizes.txt"; then
+            echo "FAILED size"
+            failed=1
+        fi
+        if ! command -v "${CROSS_COMPILE-arm-none-eabi-}gcc" > /dev/null; then
+            echo "skipped target .text check, no ${CROSS_COMPILE-arm-none-eabi-}gcc"
+        elif [ ! -f "$ROOT/tools/i2c_size_baseline.txt" ]; then
+            echo "skipped target .text check, create it with tools/i2c_size_report.sh --update tools/i2c_size_baseline.txt"
+        elif ! "$ROOT/tools/i2c_size_report.sh" --check "$ROOT/tools/i2c_size_baseline.txt"; then
+            echo "FAILED size"
+            failed=1
+        fi
+    fi
+    exit $failed
+}
@@ -0,0 +1,34 @@
+/* Checks that I2C_Clock_SysTick_NowUs stays monotonic across a reload whose
+ * interrupt has not run yet, as seen from an interrupt at or above SysTick priority.
+ */
+#include "i2c_clock.h"
+#include "check.h"
+
+SysTick_Type Host_SysTick;
+SCB_Type Host_SCB;
+
+int main(void) {
+    // 1 ms period at 8 MHz
+    SysTick->LOAD = 8000 - 1;
+    for (int i = 0; i < 5; i++) {
+        I2C_Clock_SysTick_Handler();
+    }
+
+    SysTick->VAL = 8;
+    uint32_t late = I2C_Clock_SysTick_NowUs();
+
+    // The counter reloaded, the tick interrupt is pending but hasn't incremented the ms count
+    SysTick->VAL = 8000 - 16;
+    SCB->ICSR |= SCB_ICSR_PENDSTSET_Msk;
+    uint32_t pending = I2C_Clock_SysTick_NowUs();
+    check(pending > late && pending - late < 10, "reload pending: %u -> %u us", (unsigned)late, (unsigned)pending);
+
+    // Once the interrupt runs the reading must not jump again
+    SCB->ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+    I2C_Clock_SysTick_Handler();
+    uint32_t serviced = I2C_Clock_SysTick_NowUs();
+    check(serviced == pending, "reload serviced: %u -> %u us", (unsigned)pending, (unsigned)serviced);
+
+    return checkSummary("clock: %u -> %u -> %u us across a pending reload",
+                        (unsigned)late, (unsigned)pending, (unsigned)serviced);
+}
@@ -0,0 +1,121 @@
+/* Runs the HTS221 coroutine example against a simulated sensor and reports the
+ * coroutine frame size and the suspend/resume overhead.
+ */
+#include "hts221_coro.hpp"
+
+extern "C" {
+#include "i2c_sim.h"
+}
+#include "check.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#define SWITCHES                       1000000
+#define MISSING_ADDRESS                0x30
+
+static I2C_SimTypeDef sim;
+static I2C_SimRegDeviceTypeDef sensor;
+static i2c::Scheduler scheduler;
+
+/**
+  * @brief The HTS221 uses the sub-address MSB as auto-increment flag, the register file ignores it
+  */
+static uint8_t SensorWrite(I2C_SimDeviceTypeDef *device, uint8_t byte) {
+    I2C_SimRegDeviceTypeDef *regDevice = reinterpret_cast<I2C_SimRegDeviceTypeDef *>(device);
+    if (!regDevice->addressed) {
+        regDevice->pointer = byte & 0x7F;
+        regDevice->addressed = 1;
+    } else {
+        regDevice->regs[regDevice->pointer++] = byte;
+        regDevice->writes++;
+    }
+    return 1;
+}
+
+static void RunUntilIdle() {
+    for (long steps = 0; i2c::framePool.blocksInUse(); steps++) {
+        if (steps == 1000000) {
+            check(false, "coroutine never resumed");
+            return;
+        }
+        I2C_Sim_Step(&sim);
+        scheduler.runPending();
+    }
+}
+
+/**
+  * @brief Awaitable that only goes through the ready queue, isolates the coroutine switch cost
+  */
+struct Yield {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> waiter) const noexcept { scheduler.post(waiter); }
+    void await_resume() const noexcept {}
+};
+
+static i2c::Task Switches(long count) {
+    for (long i = 0; i < count; i++) {
+        co_await Yield{};
+    }
+}
+
+static i2c::Task ReadStatus(i2c::Bus &bus, uint8_t devAddress, StatusTypeDef *status) {
+    uint8_t reg;
+    *status = co_await bus.memRead(devAddress, HTS221_STATUS_REG, std::span<uint8_t>(&reg, 1));
+}
+
+int main() {
+    static const uint8_t calibration[16] = {80, 160, 0xA0, 0x40, 0, 0x05, 0x10, 0x00, 0, 0, 0x30, 0x70, 0x10, 0x00, 0x90, 0x02};
+
+    I2C_Sim_Init(&sim, nullptr, 400000);
+    I2C_Sim_RegDeviceInit(&sensor, HTS221_SAD);
+    sensor.device.write = SensorWrite;
+    std::memcpy(&sensor.regs[HTS221_CALIB_0TOF], calibration, sizeof(calibration));
+    sensor.regs[HTS221_STATUS_REG] = 0x03;
+    sensor.regs[HTS221_HUMIDITY_OUT_LR] = 0x00;
+    sensor.regs[HTS221_HUMIDITY_OUT_HR] = 0x40;
+    sensor.regs[HTS221_TEMP_OUT_L] = 0x50;
+    sensor.regs[HTS221_TEMP_OUT_H] = 0x01;
+    I2C_Sim_Attach(&sim, &sensor.device);
+
+    i2c::Bus bus(&sim.regs, scheduler);
+    sim.handle = &bus.handle();
+
+    HTS221_Obj obj{};
+    obj.SAD = HTS221_SAD;
+    obj.state = HTS221_INITIALIZING;
+    i2c::Task acquire = hts221::Acquire(bus, obj);
+    check((bool)acquire, "Acquire got a frame");
+    RunUntilIdle();
+    check(obj.state == HTS221_READY, "Acquire finished");
+    check(obj.temperature == 46 && obj.humidity == 62, "decoded reading");
+    check(sensor.regs[HTS221_CTRL_REG1] == hts221::CTRL_REG1_PD, "sensor powered");
+    check(i2c::framePool.largestRequest() <= I2C_CORO_FRAME_SIZE, "frame fits I2C_CORO_FRAME_SIZE");
+
+    // A second awaiter on a busy Bus is refused and the first one still completes
+    StatusTypeDef first = STATUS_ERROR;
+    StatusTypeDef second = STATUS_ERROR;
+    ReadStatus(bus, HTS221_SAD, &first);
+    ReadStatus(bus, HTS221_SAD, &second);
+    RunUntilIdle();
+    check(first == STATUS_OK && second == STATUS_BUSY, "busy bus keeps the first waiter");
+
+    // A NACKed operation resumes only once the handle is READY, the next one can start right away
+    ReadStatus(bus, MISSING_ADDRESS, &first);
+    RunUntilIdle();
+    ReadStatus(bus, HTS221_SAD, &second);
+    RunUntilIdle();
+    check(first == STATUS_ERROR && second == STATUS_OK, "operation after NACK");
+    check(i2c::framePool.blocksInUse() == 0, "no frame leaked");
+
+    auto start = std::chrono::steady_clock::now();
+    Switches(SWITCHES);
+    while (scheduler.runPending()) {
+    }
+    auto end = std::chrono::steady_clock::now();
+    double switchNs = std::chrono::duration<double, std::nano>(end - start).count() / SWITCHES;
+
+    return checkSummary("coro: T=%d H=%u, frame %zu of %d bytes, suspend+resume %.1f ns",
+                        obj.temperature, obj.humidity, i2c::framePool.largestRequest(), I2C_CORO_FRAME_SIZE, switchNs);
+}
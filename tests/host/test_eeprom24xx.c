@@ -0,0 +1,163 @@
+/* Runs the paged EEPROM driver against a 24xx model on the simulated bus and compares its
+ * write throughput with byte-wise writes that wait out a fixed 5 ms write cycle.
+ * Built once per I2C_CONF_MEM_ADDRESS_16BIT setting, 8-bit builds fall back to a 24C02.
+ */
+#include "eeprom24xx.h"
+#include "eeprom24xx_model.h"
+#include "i2c_clock.h"
+#include "check.h"
+#include <string.h>
+
+#define WRITE_CYCLE_US                 3500     // Typical tWR, datasheets give 5 ms as the maximum
+#define FIXED_DELAY_US                 5000
+#define LOOP_US                        20       // Main loop period while the bus is idle
+#define MAX_ITERATIONS                 10000000
+#define OTHER_ADDRESS                  0x20
+
+#if I2C_CONF_MEM_ADDRESS_16BIT
+static const EEPROM24_ConfigTypeDef config = EEPROM24_CONFIG_24C256;
+#define BENCH_SIZE                     4096
+#else
+static const EEPROM24_ConfigTypeDef config = EEPROM24_CONFIG_24C02;
+#define BENCH_SIZE                     256
+#endif
+
+static I2C_SimTypeDef sim;
+static I2C_SimRegDeviceTypeDef other;
+static EEPROM24_ModelTypeDef model;
+static I2C_HandleTypeDef handle;
+static EEPROM24_Obj eeprom;
+static uint8_t pattern[BENCH_SIZE];
+static uint8_t readBack[BENCH_SIZE];
+static int doneCount;
+static StatusTypeDef doneStatus;
+
+static void BusCplt(I2C_HandleTypeDef *bus) {
+    (void)bus;
+    EEPROM24_Cplt_Callback(&eeprom);
+}
+
+static void Done(EEPROM24_Obj *obj, StatusTypeDef status, void *context) {
+    (void)obj;
+    (void)context;
+    doneCount++;
+    doneStatus = status;
+}
+
+/**
+  * @brief Plays main loop and bus until the driver is idle, returns the simulated time it took
+  */
+static uint32_t RunUntilIdle(void) {
+    uint32_t start = I2C_Sim_NowUs();
+
+    for (long i = 0; !EEPROM24_Idle(&eeprom) || eeprom.inFlight; i++) {
+        if (i == MAX_ITERATIONS) {
+            check(0, "driver never went idle");
+            break;
+        }
+        if (!I2C_Sim_Step(&sim)) {
+            I2C_Sim_Advance(LOOP_US);
+        }
+        EEPROM24_Process(&eeprom);
+    }
+    return I2C_Sim_NowUs() - start;
+}
+
+static void Fill(uint8_t seed) {
+    for (uint32_t i = 0; i < BENCH_SIZE; i++) {
+        pattern[i] = (uint8_t)(i * 7 + seed);
+    }
+}
+
+static int ReadMatches(uint32_t address, uint16_t size) {
+    memset(readBack, 0, size);
+    doneCount = 0;
+    if (EEPROM24_Read_IT(&eeprom, address, readBack, size, Done, NULL) != STATUS_OK) {
+        return 0;
+    }
+    RunUntilIdle();
+    return doneCount == 1 && doneStatus == STATUS_OK && memcmp(readBack, pattern, size) == 0;
+}
+
+/**
+  * @brief Byte-wise baseline, one MemWrite per byte followed by the fixed worst case delay
+  */
+static uint32_t WriteByteWise(uint32_t address, uint16_t size) {
+    uint32_t start = I2C_Sim_NowUs();
+
+    for (uint16_t i = 0; i < size; i++) {
+        uint32_t byteAddress = address + i;
+        uint8_t devAddress = (uint8_t)(EEPROM24_SAD | ((byteAddress >> (8 * config.addressSize)) & 0x7));
+        if (I2Cx_MemWrite_IT(&handle, devAddress, (uint16_t)byteAddress, config.addressSize, &pattern[i], 1) != STATUS_OK) {
+            check(0, "byte-wise write started");
+            break;
+        }
+        I2C_Sim_RunUntilIdle(&sim, 1000);
+        I2C_Sim_Advance(FIXED_DELAY_US);
+    }
+    return I2C_Sim_NowUs() - start;
+}
+
+int main(void) {
+    static I2C_CallBackHandleTypeDef callBacks = { BusCplt, BusCplt, BusCplt, BusCplt, NULL };
+    uint8_t enables[I2C_NUM_CALLBACKS] = { 1, 1, 1, 1, 0 };
+    const EEPROM24_ConfigTypeDef wide = { 64, 32768, 3, 10000 };
+
+    I2C_Clock_SetSource(I2C_Sim_NowUs);
+    I2C_Sim_Init(&sim, &handle, 400000);
+    EEPROM24_Model_Init(&model, EEPROM24_SAD, config.capacity, config.pageSize, config.addressSize, WRITE_CYCLE_US);
+    I2C_Sim_Attach(&sim, &model.device);
+    I2C_Sim_RegDeviceInit(&other, OTHER_ADDRESS);
+    I2C_Sim_Attach(&sim, &other.device);
+    I2Cx_Init(&handle, &sim.regs);
+    I2Cx_AddCallBacks(&handle, &callBacks, enables);
+    I2Cx_SetTimeoutCallBack(&handle, BusCplt);
+
+    check(EEPROM24_Init(&eeprom, &handle, EEPROM24_SAD, &wide) == STATUS_ERROR, "3 byte sub-address refused");
+#if !I2C_CONF_MEM_ADDRESS_16BIT
+    const EEPROM24_ConfigTypeDef large = EEPROM24_CONFIG_24C256;
+    check(EEPROM24_Init(&eeprom, &handle, EEPROM24_SAD, &large) == STATUS_ERROR, "2 byte sub-address refused");
+#endif
+    check(EEPROM24_Init(&eeprom, &handle, EEPROM24_SAD, &config) == STATUS_OK, "Init");
+
+    // Unaligned write over several pages, done only ever runs from EEPROM24_Process
+    uint16_t size = (uint16_t)(config.pageSize * 3 + 5);
+    uint32_t address = config.pageSize / 2 + 3;
+    Fill(1);
+    doneCount = 0;
+    check(EEPROM24_WriteAsync(&eeprom, address, pattern, size, Done, NULL) == STATUS_OK, "write queued");
+    check(doneCount == 0, "no done callback inside WriteAsync");
+    check(EEPROM24_Read_IT(&eeprom, 0, readBack, 1, Done, NULL) == STATUS_BUSY, "read waits for the queued write");
+
+    // Another transfer holds the bus when the first burst starts, it is retried instead of failed
+    uint8_t otherData;
+    check(I2Cx_MemRead_IT(&handle, OTHER_ADDRESS, 0, 1, &otherData, 1) == STATUS_OK, "other transfer started");
+    EEPROM24_Process(&eeprom);
+    check(doneCount == 0 && !eeprom.inFlight, "busy bus defers the burst");
+    RunUntilIdle();
+    check(doneCount == 1 && doneStatus == STATUS_OK, "unaligned write done");
+    check(model.pageWrites == (address + size - 1) / config.pageSize - address / config.pageSize + 1, "one page write per page");
+    check(ReadMatches(address, size), "unaligned write read back");
+
+    // Paged driver against byte-wise writes with a fixed delay
+    Fill(2);
+    uint32_t pageWrites = model.pageWrites;
+    uint32_t busyNacks = model.busyNacks;
+    doneCount = 0;
+    check(EEPROM24_WriteAsync(&eeprom, 0, pattern, BENCH_SIZE, Done, NULL) == STATUS_OK, "bench write queued");
+    uint32_t pagedUs = RunUntilIdle();
+    check(doneCount == 1 && doneStatus == STATUS_OK, "bench write done");
+    check(ReadMatches(0, BENCH_SIZE), "bench write read back");
+    pageWrites = model.pageWrites - pageWrites;
+    busyNacks = model.busyNacks - busyNacks;
+
+    Fill(3);
+    I2C_Sim_Advance(FIXED_DELAY_US);
+    uint32_t byteWiseUs = WriteByteWise(0, BENCH_SIZE);
+    check(ReadMatches(0, BENCH_SIZE), "byte-wise write read back");
+    check(pagedUs < byteWiseUs, "paged writes are faster");
+
+    return checkSummary("eeprom: %u B paged in %u us (%.1f kB/s, %u page writes, %u busy NACKs), byte-wise with %u us delay %u us (%.2f kB/s), %.0fx",
+           (unsigned)BENCH_SIZE, (unsigned)pagedUs, BENCH_SIZE * 1000.0 / pagedUs, (unsigned)pageWrites, (unsigned)busyNacks,
+           (unsigned)FIXED_DELAY_US, (unsigned)byteWiseUs, BENCH_SIZE * 1000.0 / byteWiseUs, (double)byteWiseUs / pagedUs);
+}
@@ -0,0 +1,48 @@
+/* Checks the argument and busy handling of the interrupt driven memory functions.
+ * Built once per I2C_CONF_MEM_ADDRESS_16BIT setting.
+ */
+#include "i2c_sim.h"
+#include "check.h"
+
+#define DEVICE_ADDRESS                 0x20
+#define MISSING_ADDRESS                0x30
+
+static I2C_SimTypeDef sim;
+static I2C_SimRegDeviceTypeDef device;
+static I2C_HandleTypeDef handle;
+
+int main(void) {
+    uint8_t data[2] = {0x5A, 0xA5};
+
+    I2C_Sim_Init(&sim, &handle, 400000);
+    I2C_Sim_RegDeviceInit(&device, DEVICE_ADDRESS);
+    I2C_Sim_Attach(&sim, &device.device);
+    I2Cx_Init(&handle, &sim.regs);
+
+    // Sub-address sizes the handle can't send are refused before the bus is touched
+    check(I2Cx_MemWrite_IT(&handle, DEVICE_ADDRESS, 0x10, 0, data, 2) == STATUS_ERROR, "memSize 0 refused");
+    check(I2Cx_MemRead_IT(&handle, DEVICE_ADDRESS, 0x10, 3, data, 2) == STATUS_ERROR, "memSize 3 refused");
+#if !I2C_CONF_MEM_ADDRESS_16BIT
+    check(I2Cx_MemWrite_IT(&handle, DEVICE_ADDRESS, 0x0010, 2, data, 2) == STATUS_ERROR, "memSize 2 refused");
+#endif
+    check(handle.state == I2C_READY && sim.regs.CR2 == 0, "refused requests leave the bus alone");
+#if I2C_CONF_MEM_ADDRESS_16BIT
+    // The register file takes the high sub-address byte as its pointer and the low one as data
+    check(I2Cx_MemWrite_IT(&handle, DEVICE_ADDRESS, 0x0110, 2, data, 2) == STATUS_OK, "memSize 2 accepted");
+    I2C_Sim_RunUntilIdle(&sim, 1000);
+    check(device.regs[0x01] == 0x10 && device.regs[0x02] == 0x5A && device.regs[0x03] == 0xA5, "two byte sub-address sent");
+#endif
+
+    // A refused request must not overwrite the error of the transfer in flight
+    check(I2Cx_MemRead_IT(&handle, MISSING_ADDRESS, 0x10, 1, data, 1) == STATUS_OK, "read to missing device started");
+    for (int steps = 0; handle.error != I2C_ERROR_NACK && steps < 100; steps++) {
+        I2C_Sim_Step(&sim);
+    }
+    check(handle.error == I2C_ERROR_NACK && handle.state != I2C_READY, "NACK pending");
+    check(I2Cx_MemRead_IT(&handle, DEVICE_ADDRESS, 0x10, 1, data, 1) == STATUS_BUSY, "second request refused");
+    check(handle.error == I2C_ERROR_NACK, "NACK kept");
+    I2C_Sim_RunUntilIdle(&sim, 1000);
+    check(handle.state == I2C_READY, "NACKed transfer completed");
+
+    return checkSummary("handle: %u byte sub-addresses", (unsigned)sizeof(I2C_MemAddressTypeDef));
+}
@@ -0,0 +1,116 @@
+/* Several POSIX threads share one simulated bus through I2Cx_Transfer while a
+ * separate thread plays the I2C event interrupt and I2Cx_TimeoutTick.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "i2c_rtos.h"
+#include "i2c_sim.h"
+#include "check.h"
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#define TASKS                          4
+#define ITERATIONS                     2000
+#define DEVICE_ADDRESS                 0x20
+#define MISSING_ADDRESS                0x30
+#define TIMEOUT_US                     1000000  // Generous, host scheduling is not under test
+
+static I2C_RTOS_HandleTypeDef bus;
+static I2C_SimTypeDef sim;
+static I2C_SimRegDeviceTypeDef device;
+static volatile int running = 1;
+static volatile int tickEnabled = 1;
+static void *interruptThread(void *arg) {
+    struct timespec nap = {0, 50000};
+    (void)arg;
+
+    while (running) {
+        I2C_OS_EnterCritical();
+        uint8_t busy = I2C_Sim_Step(&sim);
+        if (tickEnabled) {
+            I2Cx_TimeoutTick(&bus.handle);
+        }
+        uint8_t stopPending = sim.stopPending;
+        I2C_OS_ExitCritical();
+        // Leave a window between NACK and STOP, a task woken early would submit into it
+        if (!busy || stopPending) {
+            nanosleep(&nap, NULL);
+        }
+    }
+    return NULL;
+}
+
+static void *taskThread(void *arg) {
+    int task = (int)(intptr_t)arg;
+    uint8_t reg = (uint8_t)(task * 16);
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        uint8_t out[4] = {(uint8_t)task, (uint8_t)i, (uint8_t)(i >> 8), 0xA5};
+        uint8_t in[4] = {0};
+        StatusTypeDef status;
+
+        status = I2Cx_Transfer(&bus, I2C_MEM_WRITE, DEVICE_ADDRESS, reg, 1, out, sizeof(out), TIMEOUT_US);
+        check(status == STATUS_OK, "write: task %d iteration %d status %d", task, i, status);
+        status = I2Cx_Transfer(&bus, I2C_MEM_READ, DEVICE_ADDRESS, reg, 1, in, sizeof(in), TIMEOUT_US);
+        check(status == STATUS_OK && memcmp(in, out, sizeof(out)) == 0, "read back: task %d iteration %d status %d", task, i, status);
+
+        if (i % 16 == 0) {
+            // The NACKed transfer must be fully finished when it returns, the next one can't see BUSY
+            status = I2Cx_Transfer(&bus, I2C_WRITE_IT, MISSING_ADDRESS, 0, 0, out, 1, TIMEOUT_US);
+            check(status == STATUS_ERROR, "nack: task %d iteration %d status %d", task, i, status);
+            status = I2Cx_Transfer(&bus, I2C_MEM_READ, DEVICE_ADDRESS, reg, 1, in, sizeof(in), TIMEOUT_US);
+            check(status == STATUS_OK && memcmp(in, out, sizeof(out)) == 0, "after nack: task %d iteration %d status %d", task, i, status);
+        }
+    }
+    return NULL;
+}
+
+/**
+  * @brief With I2Cx_TimeoutTick stopped and the device stretching SCL, only the OS wait ends the transfer
+  */
+static void testBackstop(void) {
+    uint8_t data[2] = {1, 2};
+
+    tickEnabled = 0;
+    sim.frozen = 1;
+    StatusTypeDef status = I2Cx_Transfer(&bus, I2C_MEM_WRITE, DEVICE_ADDRESS, 0xF0, 1, data, sizeof(data), 2000);
+    check(status == STATUS_TIMEOUT, "backstop status %d", status);
+    check(bus.handle.state == I2C_READY && !(sim.regs.CR1 & (I2C_CR1_TXIE | I2C_CR1_STOPIE)), "backstop left the transfer running");
+
+    I2C_OS_EnterCritical();
+    I2C_Sim_Reset(&sim);
+    I2C_OS_ExitCritical();
+    tickEnabled = 1;
+
+    status = I2Cx_Transfer(&bus, I2C_MEM_WRITE, DEVICE_ADDRESS, 0xF0, 1, data, sizeof(data), TIMEOUT_US);
+    check(status == STATUS_OK && device.regs[0xF1] == 2, "after backstop: status %d", status);
+}
+
+int main(void) {
+    pthread_t interrupt;
+    pthread_t tasks[TASKS];
+
+    I2C_Clock_SetSource(I2C_Clock_POSIX_NowUs);
+    I2C_Sim_Init(&sim, &bus.handle, 400000);
+    I2C_Sim_RegDeviceInit(&device, DEVICE_ADDRESS);
+    I2C_Sim_Attach(&sim, &device.device);
+    if (I2Cx_RTOS_Init(&bus, &sim.regs) != STATUS_OK) {
+        check(0, "init");
+        return 1;
+    }
+
+    pthread_create(&interrupt, NULL, interruptThread, NULL);
+    for (int i = 0; i < TASKS; i++) {
+        pthread_create(&tasks[i], NULL, taskThread, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < TASKS; i++) {
+        pthread_join(tasks[i], NULL);
+    }
+    testBackstop();
+    running = 0;
+    pthread_join(interrupt, NULL);
+
+    return checkSummary("rtos contention: %d tasks x %d iterations, %u bytes written, %u read",
+                        TASKS, ITERATIONS, (unsigned)device.writes, (unsigned)device.reads);
+}
@@ -0,0 +1,199 @@
+/* Checks the transaction deadlines. Polling transfers get one deadline for the whole transfer and
+ * stop early on a NACK, a stuck interrupt driven transfer is aborted by I2Cx_TimeoutTick.
+ * Polling transfers step the model from their clock source, a stalled bus only lets time pass.
+ * The device stalls the bus after its address or first data byte, see I2C_Sim_Step for why
+ * polling transfers here move at most one data byte.
+ * Without a deadline the clock is never read, a thread then runs the bus like the real peripheral.
+ */
+#include "i2c_sim.h"
+#include "check.h"
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEVICE_ADDRESS                 0x20
+#define MISSING_ADDRESS                0x30
+#define IE_BITS                        (I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_NACKIE | I2C_CR1_STOPIE | I2C_CR1_TCIE)
+
+static I2C_SimTypeDef sim;
+static I2C_SimRegDeviceTypeDef device;
+static I2C_HandleTypeDef handle;
+static int timeoutCallBacks;
+static uint8_t timeoutError;
+static volatile int busRunning;
+static uint8_t (*regSelect)(I2C_SimDeviceTypeDef *device, uint8_t read);
+static uint8_t (*regWrite)(I2C_SimDeviceTypeDef *device, uint8_t byte);
+static uint8_t stallAfterSelect;
+static uint8_t stallAfterWrite;
+
+/**
+  * @brief Clock source for the polling tests, every deadline check advances the bus by one event
+  * and spends 1 us of CPU time, so time passes even when the bus can't move
+  */
+static uint32_t SteppingNowUs(void) {
+    I2C_Sim_Step(&sim);
+    I2C_Sim_Advance(1);
+    return I2C_Sim_NowUs();
+}
+
+/**
+  * @brief Register device that holds SCL low after its address or first data byte when asked to
+  */
+static uint8_t StallingSelect(I2C_SimDeviceTypeDef *dev, uint8_t read) {
+    uint8_t ack = regSelect(dev, read);
+    sim.frozen = stallAfterSelect;
+    return ack;
+}
+
+static uint8_t StallingWrite(I2C_SimDeviceTypeDef *dev, uint8_t byte) {
+    uint8_t ack = regWrite(dev, byte);
+    sim.frozen = stallAfterWrite;
+    return ack;
+}
+
+static void *busThread(void *arg) {
+    const struct timespec nap = {0, 10000};
+
+    (void)arg;
+    while (busRunning) {
+        if (!I2C_Sim_Step(&sim)) {
+            nanosleep(&nap, NULL);
+        }
+    }
+    return NULL;
+}
+
+static void TimeoutCallBack(I2C_HandleTypeDef *bus) {
+    timeoutCallBacks++;
+    timeoutError = bus->error;
+}
+
+static void testPollingNack(void) {
+    uint8_t data[2] = {1, 2};
+    uint32_t start = I2C_Sim_NowUs();
+
+    // The whole budget must not be spent waiting for a TXIS that never comes
+    StatusTypeDef status = I2Cx_Write(&handle, MISSING_ADDRESS, data, sizeof(data), 200000);
+    uint32_t elapsed = I2C_Sim_NowUs() - start;
+    check(status == STATUS_ERROR && handle.error == I2C_ERROR_NACK, "polling write NACK: status %d error %u", status, handle.error);
+    check(elapsed < 1000, "polling write NACK took %u us", (unsigned)elapsed);
+    check(handle.state == I2C_READY, "polling write NACK left state %u", handle.state);
+    I2C_Sim_Step(&sim);
+    check(!(sim.regs.ISR & (I2C_ISR_NACKF | I2C_ISR_STOPF)), "NACKF and STOPF cleared");
+
+    // Without a deadline it must return too, alarm() ends the test if it hangs
+    pthread_t bus;
+    I2C_Clock_SetSource(I2C_Sim_NowUs);
+    busRunning = 1;
+    pthread_create(&bus, NULL, busThread, NULL);
+    alarm(10);
+    status = I2Cx_Read(&handle, MISSING_ADDRESS, data, sizeof(data), I2C_TIMEOUT_INFINITE);
+    alarm(0);
+    busRunning = 0;
+    pthread_join(bus, NULL);
+    I2C_Clock_SetSource(SteppingNowUs);
+    check(status == STATUS_ERROR && handle.error == I2C_ERROR_NACK, "polling read NACK: status %d error %u", status, handle.error);
+#if I2C_CONF_STATS
+    check(handle.stats.nacks == 2, "nack stat %u", (unsigned)handle.stats.nacks);
+#endif
+
+    status = I2Cx_Write(&handle, DEVICE_ADDRESS, data, 1, 200000);
+    check(status == STATUS_OK && device.pointer == 1, "polling write after NACK: status %d", status);
+}
+
+/**
+  * @brief Runs a polling transfer against a bus that stalls part way through
+  */
+static void checkStalled(const char *what, uint8_t read, uint16_t size, uint32_t stallAfterUs) {
+    uint8_t data[2] = {0x5A, 0xA5};
+
+    uint32_t start = I2C_Sim_NowUs();
+    StatusTypeDef status = read ? I2Cx_Read(&handle, DEVICE_ADDRESS, data, size, 500)
+                                : I2Cx_Write(&handle, DEVICE_ADDRESS, data, size, 500);
+    uint32_t elapsed = I2C_Sim_NowUs() - start;
+
+    // A deadline restarted per flag would end stallAfterUs later
+    check(status == STATUS_TIMEOUT && handle.error == I2C_ERROR_TIMEOUT, "%s: status %d error %u", what, status, handle.error);
+    check(elapsed >= 500 && elapsed < 510, "%s gave up after %u us, stalled after %u us", what, (unsigned)elapsed, (unsigned)stallAfterUs);
+    check(handle.state == I2C_READY, "%s left state %u", what, handle.state);
+    I2C_Sim_Reset(&sim);
+}
+
+static void testPollingDeadline(void) {
+    uint8_t data[2] = {1, 2};
+
+    // 100 kHz, the address phase takes 100 us and every data byte 90 us
+    stallAfterSelect = 1;
+    checkStalled("write stalled after the address", 0, 2, 100);
+    checkStalled("read stalled after the address", 1, 2, 100);
+    stallAfterSelect = 0;
+
+    stallAfterWrite = 1;
+    checkStalled("write stalled after a data byte", 0, 1, 190);
+    stallAfterWrite = 0;
+
+    // Stalled before the address
+    sim.frozen = 1;
+    checkStalled("write on a stalled bus", 0, 2, 0);
+    sim.frozen = 1;
+    checkStalled("read on a stalled bus", 1, 2, 0);
+
+    StatusTypeDef status = I2Cx_Write(&handle, DEVICE_ADDRESS, data, 1, 500);
+    check(status == STATUS_OK, "polling write after timeouts: status %d", status);
+}
+
+static void testTick(void) {
+    uint8_t data[2] = {1, 2};
+
+    I2C_Clock_SetSource(I2C_Sim_NowUs);
+    I2Cx_SetTimeout(&handle, 1000);
+    I2Cx_SetTimeoutCallBack(&handle, TimeoutCallBack);
+
+    sim.frozen = 1;
+    check(I2Cx_Write_IT(&handle, DEVICE_ADDRESS, data, sizeof(data)) == STATUS_OK, "IT write started");
+    I2C_Sim_Step(&sim);
+
+    I2C_Sim_Advance(500);
+    I2Cx_TimeoutTick(&handle);
+    check(handle.state != I2C_READY && timeoutCallBacks == 0, "tick before the deadline left the transfer alone");
+
+    I2C_Sim_Advance(600);
+    I2Cx_TimeoutTick(&handle);
+    check(handle.state == I2C_READY, "tick left state %u", handle.state);
+    check(!(sim.regs.CR1 & IE_BITS), "tick left CR1 interrupts on: 0x%x", (unsigned)sim.regs.CR1);
+    check(timeoutCallBacks == 1 && timeoutError == I2C_ERROR_TIMEOUT, "timeout callback ran %d times with error %u", timeoutCallBacks, timeoutError);
+#if I2C_CONF_STATS
+    check(handle.stats.timeouts == 1, "timeout stat %u", (unsigned)handle.stats.timeouts);
+#endif
+
+    I2C_Sim_Advance(2000);
+    I2Cx_TimeoutTick(&handle);
+    check(timeoutCallBacks == 1, "idle tick ran the callback again");
+    I2C_Sim_Reset(&sim);
+
+    check(I2Cx_Write_IT(&handle, DEVICE_ADDRESS, data, sizeof(data)) == STATUS_OK && I2C_Sim_RunUntilIdle(&sim, 1000),
+          "IT write after the abort");
+    check(handle.state == I2C_READY && timeoutCallBacks == 1, "IT write after the abort completed");
+}
+
+int main(void) {
+    I2C_Sim_Init(&sim, &handle, 100000);
+    I2C_Sim_RegDeviceInit(&device, DEVICE_ADDRESS);
+    regSelect = device.device.select;
+    regWrite = device.device.write;
+    device.device.select = StallingSelect;
+    device.device.write = StallingWrite;
+    I2C_Sim_Attach(&sim, &device.device);
+    I2Cx_Init(&handle, &sim.regs);
+    I2C_Clock_SetSource(SteppingNowUs);
+
+    testPollingNack();
+    testPollingDeadline();
+#if I2C_CONF_STATS
+    check(handle.stats.timeouts == 5, "polling timeout stat %u", (unsigned)handle.stats.timeouts);
+    handle.stats.timeouts = 0;
+#endif
+    testTick();
+
+    return checkSummary("timeout: polling NACK, polling deadline and tick abort at %u kHz", (unsigned)(1000000 / sim.bitTimeNs));
+}
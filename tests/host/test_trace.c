@@ -0,0 +1,158 @@
+/* Checks the trace of a memory read and of a NACKed write record by record, that every record
+ * including the reset in I2Cx_Init carries its bus, and that tools/i2c_trace2json.py converts the
+ * dumped ring into monotonic timestamps across a CYCCNT wrap and an idle gap longer than 2^31 cycles.
+ * Host_DWT stands in for the cycle counter the records are timestamped with.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "i2c_sim.h"
+#include "i2c_trace.h"
+#include "check.h"
+
+#define DEVICE_ADDRESS                 0x20
+#define ABSENT_ADDRESS                 0x30
+#define CYCLES_PER_STEP                16
+#define IDLE_GAP_CYCLES                0x90000000u
+
+#ifndef TRACE2JSON_TEST
+#error "Define TRACE2JSON_TEST as the path of tests/host/test_trace2json.py"
+#endif
+
+typedef struct {
+    uint8_t type;
+    uint8_t arg;
+    uint16_t data;
+} ExpectedTypeDef;
+
+static const ExpectedTypeDef memRead[] = {
+    { I2C_TRACE_SUBMIT,   I2C_MEM_READ,           2 },
+    { I2C_TRACE_STATE,    I2C_BUSY_TX_SUBADDRESS, I2C_READY },
+    { I2C_TRACE_START,    DEVICE_ADDRESS,         1 },
+    { I2C_TRACE_ISR,      0,                      I2C_ISR_TXIS },
+    { I2C_TRACE_ISR,      0,                      I2C_ISR_TC },
+    { I2C_TRACE_STATE,    I2C_BUSY_RX,            I2C_BUSY_TX_SUBADDRESS },
+    { I2C_TRACE_START,    DEVICE_ADDRESS,         2 | 0x8000 },
+    { I2C_TRACE_ISR,      0,                      I2C_ISR_RXNE },
+    { I2C_TRACE_ISR,      0,                      I2C_ISR_RXNE },
+    { I2C_TRACE_ISR,      0,                      I2C_ISR_STOPF },
+    { I2C_TRACE_STOP,     0,                      0 },
+    { I2C_TRACE_CALLBACK, I2C_MemRxCplt,          0 },
+    { I2C_TRACE_STATE,    I2C_READY,              I2C_BUSY_RX },
+};
+
+// The device NACKs its address, the write still completes through STOPF with the error set
+static const ExpectedTypeDef nackedWrite[] = {
+    { I2C_TRACE_SUBMIT,   I2C_WRITE_IT,           1 },
+    { I2C_TRACE_STATE,    I2C_BUSY_TX,            I2C_READY },
+    { I2C_TRACE_START,    ABSENT_ADDRESS,         1 },
+    { I2C_TRACE_ISR,      0,                      I2C_ISR_NACKF },
+    { I2C_TRACE_NACK,     I2C_BUSY_TX,            0 },
+    { I2C_TRACE_CALLBACK, I2C_NackReceived,       0 },
+    { I2C_TRACE_ISR,      0,                      I2C_ISR_STOPF },
+    { I2C_TRACE_STOP,     0,                      0 },
+    { I2C_TRACE_CALLBACK, I2C_WriteCplt,          0 },
+    { I2C_TRACE_STATE,    I2C_READY,              I2C_BUSY_TX },
+};
+
+DWT_Type Host_DWT;
+
+static I2C_SimTypeDef sim;
+static I2C_SimRegDeviceTypeDef device;
+static I2C_HandleTypeDef handle;
+static uint8_t completedError;
+
+static void Completed(I2C_HandleTypeDef *h) {
+    completedError = h->error;
+}
+
+static void Run(void) {
+    while (I2C_Sim_Step(&sim)) {
+        Host_DWT.CYCCNT += CYCLES_PER_STEP;
+    }
+}
+
+/**
+  * @brief Compares the records from first on with expected, returns the index after them
+  */
+static uint32_t CheckSequence(const char *what, uint32_t first, const ExpectedTypeDef *expected, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const I2C_TraceRecordTypeDef *record = &I2C_Trace_Ring.records[first + i];
+        uint8_t type = record->event & 0xF;
+        if (first + i >= I2C_Trace_Ring.head || type != expected[i].type || record->arg != expected[i].arg || record->data != expected[i].data) {
+            check(0, "%s record %u is %u/0x%02x/0x%04x, expected %u/0x%02x/0x%04x", what, (unsigned)i,
+                  (unsigned)type, (unsigned)record->arg, (unsigned)record->data,
+                  (unsigned)expected[i].type, (unsigned)expected[i].arg, (unsigned)expected[i].data);
+            break;
+        }
+    }
+    return first + count;
+}
+
+/**
+  * @brief Dumps the ring as gdb would and runs the converter check on it
+  */
+static void CheckConverter(void) {
+    char path[] = "/tmp/i2c_traceXXXXXX";
+    char command[512];
+    int fd = mkstemp(path);
+
+    check(fd >= 0, "dump file created");
+    if (fd < 0) {
+        return;
+    }
+    FILE *dump = fdopen(fd, "wb");
+    check(fwrite(&I2C_Trace_Ring, sizeof(I2C_Trace_Ring), 1, dump) == 1, "ring dumped");
+    fclose(dump);
+
+    snprintf(command, sizeof(command), "python3 '%s' '%s' %u %u", TRACE2JSON_TEST, path,
+             (unsigned)I2C_Trace_Ring.head, (unsigned)IDLE_GAP_CYCLES);
+    check(system(command) == 0, "converter check: %s", command);
+    remove(path);
+}
+
+int main(void) {
+    static I2C_CallBackHandleTypeDef callBacks = { Completed, Completed, Completed, Completed, Completed };
+    uint8_t enables[I2C_NUM_CALLBACKS] = { 1, 1, 1, 1, 1 };
+    uint8_t data[2] = { 0x5A, 0 };
+    uint8_t bus = (uint8_t)(((uintptr_t)&sim.regs >> 10) & 0xF);
+
+    I2C_Sim_Init(&sim, &handle, 400000);
+    I2C_Sim_RegDeviceInit(&device, DEVICE_ADDRESS);
+    device.regs[0x10] = 0x12;
+    device.regs[0x11] = 0x34;
+    I2C_Sim_Attach(&sim, &device.device);
+
+    // Close enough to the wrap that the counter rolls over during the read
+    Host_DWT.CYCCNT = 0xFFFFFFFFu - 4 * CYCLES_PER_STEP;
+    I2C_Trace_Reset();
+    I2Cx_Init(&handle, &sim.regs);
+    check(I2C_Trace_Ring.head == 1, "Init records the reset");
+    I2Cx_AddCallBacks(&handle, &callBacks, enables);
+
+    check(I2Cx_MemRead_IT(&handle, DEVICE_ADDRESS, 0x10, 1, data, 2) == STATUS_OK, "read started");
+    Run();
+    check(data[0] == 0x12 && data[1] == 0x34, "read done");
+    check(Host_DWT.CYCCNT < 0x1000, "CYCCNT wrapped during the read");
+
+    Host_DWT.CYCCNT += IDLE_GAP_CYCLES;
+    check(I2Cx_Write_IT(&handle, ABSENT_ADDRESS, data, 1) == STATUS_OK, "write started");
+    Run();
+    check(completedError == I2C_ERROR_NACK, "write completed NACKed");
+
+    uint32_t next = CheckSequence("read", 1, memRead, sizeof(memRead) / sizeof(memRead[0]));
+    next = CheckSequence("NACKed write", next, nackedWrite, sizeof(nackedWrite) / sizeof(nackedWrite[0]));
+    check(I2C_Trace_Ring.head == next, "%u records, expected %u", (unsigned)I2C_Trace_Ring.head, (unsigned)next);
+
+    uint32_t count = I2C_Trace_Ring.head < I2C_TRACE_SIZE ? I2C_Trace_Ring.head : I2C_TRACE_SIZE;
+    uint32_t wrongBus = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if ((I2C_Trace_Ring.records[i].event >> 4) != bus) {
+            wrongBus++;
+        }
+    }
+    check(wrongBus == 0, "records carry the handle's bus");
+
+    CheckConverter();
+
+    return checkSummary("trace: %u records on bus %u, %u on another bus", (unsigned)count, (unsigned)bus, (unsigned)wrongBus);
+}
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""Checks tools/i2c_trace2json.py, run by test_trace with the ring it recorded.
+
+The ring holds a read that runs across a CYCCNT wrap and a write after an idle gap of more
+than 2^31 cycles. With --cpu-hz 1e6 a cycle converts to 1 us, so ts can be compared to cycles.
+
+Usage: tests/host/test_trace2json.py trace.bin records idle-gap-cycles
+"""
+
+import importlib.util
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+CONVERTER = os.path.join(ROOT, "tools", "i2c_trace2json.py")
+
+failures = 0
+
+
+def check(ok, message):
+    global failures
+    if not ok:
+        failures += 1
+        print("FAIL %s" % message)
+
+
+def load_converter():
+    spec = importlib.util.spec_from_file_location("i2c_trace2json", CONVERTER)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+
+def check_unwrap(converter):
+    def unwrapped(timestamps):
+        return [record[0] for record in converter.unwrap([(t, 0) for t in timestamps])]
+
+    check(unwrapped([0xFFFFFFF0, 0x10]) == [0xFFFFFFF0, 0x100000010], "wrap between two records")
+    check(unwrapped([0x1000, 0xF00, 0x1100]) == [0x1000, 0xF00, 0x1100], "preemption skew steps back")
+    check(unwrapped([0x10, 0xA0000010]) == [0x10, 0xA0000010], "idle gap over 2^31 cycles runs forward")
+    check(unwrapped([0x10, 0x10 - converter.SKEW_CYCLES]) == [0x10, 0x100000010 - converter.SKEW_CYCLES],
+          "step back of SKEW_CYCLES is a gap")
+
+
+def check_dump(dump, records, gap):
+    with tempfile.TemporaryDirectory() as work:
+        output = os.path.join(work, "trace.json")
+        result = subprocess.run([sys.executable, CONVERTER, dump, "--cpu-hz", "1e6", "-o", output])
+        check(result.returncode == 0, "converter exit status %d" % result.returncode)
+        if result.returncode != 0:
+            return
+        with open(output) as f:
+            trace = json.load(f)
+
+    events = trace["traceEvents"]
+    instants = [event["ts"] for event in events if event["ph"] == "i"]
+    spans = [event for event in events if event["ph"] == "X"]
+    check(trace["otherData"]["events"] == records, "%d events converted, expected %d" % (trace["otherData"]["events"], records))
+    check(all(b >= a for a, b in zip(instants, instants[1:])), "instant timestamps are monotonic")
+    check(all(span["dur"] >= 0 for span in spans), "state spans have no negative duration")
+    check(instants and gap <= instants[-1] - instants[0] < gap + 0x10000,
+          "trace spans the idle gap of %d cycles" % gap)
+
+
+def main():
+    dump, records, gap = sys.argv[1], int(sys.argv[2]), int(sys.argv[3])
+    check_unwrap(load_converter())
+    check_dump(dump, records, gap)
+    print("trace2json: %d records, %d failures" % (records, failures))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
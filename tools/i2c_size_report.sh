@@ -0,0 +1,90 @@
+#!/bin/sh
+# Builds the I2C driver once per configuration profile and reports the size of
+# I2C_HandleTypeDef and the driver's .text, so footprint regressions show up in review.
+#
+# Usage: tools/i2c_size_report.sh [--handles] [--update BASELINE | --check BASELINE]
+#   --handles  report the handle size only, .text of a host build says nothing about the target
+#   --update   write the current report to BASELINE
+#   --check    fail if any profile grew compared to BASELINE
+#
+# tools/i2c_size_baseline.txt is the target baseline, create it with --update once an arm toolchain
+# and I2C_SIZE_CFLAGS are set up, tests/host/run_tests.sh checks it from then on.
+#
+# Environment:
+#   CROSS_COMPILE    toolchain prefix, default arm-none-eabi-
+#   I2C_SIZE_CFLAGS  target flags plus the include paths for CMSIS and commons.h and the
+#                    device header, e.g. "-mcpu=cortex-m0plus -mthumb -Iinc -include stm32l0xx.h"
+
+set -eu
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+CROSS_COMPILE=${CROSS_COMPILE-arm-none-eabi-}
+CC="${CROSS_COMPILE}gcc"
+NM="${CROSS_COMPILE}nm"
+SIZE="${CROSS_COMPILE}size"
+CFLAGS="-Os -ffunction-sections -fdata-sections ${I2C_SIZE_CFLAGS:-}"
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+HANDLES=0
+if [ "${1:-}" = "--handles" ]; then
+    HANDLES=1
+    shift
+fi
+
+# name|I2C_CONF_* overrides
+PROFILES='full|
+full_stats|-DI2C_CONF_STATS=1
+polling|-DI2C_CONF_IT=0 -DI2C_CONF_MEM=0 -DI2C_CONF_CALLBACKS=0 -DI2C_CONF_PREVIOUS_STATE=0
+it|-DI2C_CONF_POLLING=0 -DI2C_CONF_MEM=0 -DI2C_CONF_PREVIOUS_STATE=0
+it_mem8_nocb|-DI2C_CONF_POLLING=0 -DI2C_CONF_CALLBACKS=0 -DI2C_CONF_PREVIOUS_STATE=0 -DI2C_CONF_MEM_ADDRESS_16BIT=0'
+
+report() {
+    if [ $HANDLES = 1 ]; then
+        printf '%-14s %8s\n' profile handle
+    else
+        printf '%-14s %8s %8s\n' profile handle text
+    fi
+    echo "$PROFILES" | while IFS='|' read -r name flags; do
+        printf '#include "i2c.h"\nI2C_HandleTypeDef i2c_size_probe;\n' > "$WORK/probe.c"
+        # shellcheck disable=SC2086
+        $CC $CFLAGS $flags -fno-common -I"$ROOT/I2C" -c "$WORK/probe.c" -o "$WORK/probe.o"
+        handle=$(printf '%d' "0x$($NM -S "$WORK/probe.o" | awk '$4 == "i2c_size_probe" { print $2 }')")
+        if [ $HANDLES = 1 ]; then
+            printf '%-14s %8d\n' "$name" "$handle"
+            continue
+        fi
+
+        # shellcheck disable=SC2086
+        $CC $CFLAGS $flags -I"$ROOT/I2C" -c "$ROOT/I2C/i2c.c" -o "$WORK/i2c.o"
+        # shellcheck disable=SC2086
+        $CC $CFLAGS $flags -I"$ROOT/I2C" -c "$ROOT/I2C/i2c_clock.c" -o "$WORK/i2c_clock.o"
+        text=$($SIZE "$WORK/i2c.o" "$WORK/i2c_clock.o" | awk 'NR > 1 { sum += $1 } END { print sum }')
+        printf '%-14s %8d %8d\n' "$name" "$handle" "$text"
+    done
+}
+
+case "${1:-}" in
+    --update)
+        report > "$2"
+        cat "$2"
+        ;;
+    --check)
+        report > "$WORK/current"
+        cat "$WORK/current"
+        awk 'NR == FNR { handle[$1] = $2; text[$1] = $3; next }
+             FNR > 1 && ($1 in handle) && ($2 > handle[$1] || $3 > text[$1]) {
+                 if ($3 == "") printf "%s grew: handle %d -> %d\n", $1, handle[$1], $2
+                 else printf "%s grew: handle %d -> %d, text %d -> %d\n", $1, handle[$1], $2, text[$1], $3
+                 failed = 1
+             }
+             END { exit failed }' "$2" "$WORK/current"
+        ;;
+    "")
+        report
+        ;;
+    *)
+        sed -n '5,16p' "$0"
+        exit 2
+        ;;
+esac
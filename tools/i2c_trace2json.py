@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Converts a raw dump of I2C_Trace_Ring (see I2C/i2c_trace.h) into Chrome trace JSON.
+
+Open the output in chrome://tracing or https://ui.perfetto.dev. Each bus becomes a
+thread, handle states become spans and every other event is an instant marker.
+
+Usage: tools/i2c_trace2json.py trace.bin --cpu-hz 72000000 [-o trace.json]
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x54433249
+HEADER = struct.Struct("<IHHII")
+RECORD = struct.Struct("<IBBH")
+
+EVENTS = {
+    0x01: "submit",
+    0x02: "START",
+    0x03: "isr",
+    0x04: "state",
+    0x05: "NACK",
+    0x06: "STOP",
+    0x07: "callback",
+    0x08: "TIMEOUT",
+}
+OPERATIONS = ["NONE", "WRITE", "READ", "WRITE_IT", "READ_IT", "MEM_WRITE", "MEM_READ"]
+STATES = ["READY", "BUSY_TX_SUBADDRESS", "BUSY_TX", "BUSY_RX"]
+CALLBACKS = ["WriteCplt", "ReadCplt", "MemTxCplt", "MemRxCplt", "NackReceived", "Timeout"]
+ISR_FLAGS = {1 << 1: "TXIS", 1 << 2: "RXNE", 1 << 4: "NACKF", 1 << 5: "STOPF", 1 << 6: "TC", 1 << 7: "TCR"}
+
+
+def name_of(table, index):
+    if isinstance(table, dict):
+        return table.get(index, hex(index))
+    return table[index] if index < len(table) else str(index)
+
+
+def read_records(dump):
+    """Returns the records oldest first, as (timestamp, type, bus, arg, data)."""
+    magic, version, capacity, head, _ = HEADER.unpack_from(dump, 0)
+    if magic != MAGIC:
+        sys.exit("not an I2C trace dump (bad magic 0x%08x)" % magic)
+    if version != 1:
+        sys.exit("unsupported trace version %d" % version)
+    if len(dump) < HEADER.size + capacity * RECORD.size:
+        sys.exit("dump is truncated: %d records expected" % capacity)
+
+    count = min(head, capacity)
+    first = head - count
+    records = []
+    for n in range(first, head):
+        offset = HEADER.size + (n % capacity) * RECORD.size
+        timestamp, event, arg, data = RECORD.unpack_from(dump, offset)
+        records.append((timestamp, event & 0xF, event >> 4, arg, data))
+    return records, head - count
+
+
+# A record can be timestamped a little before the one ahead of it when an interrupt records between
+# another context's slot reservation and its CYCCNT read. Steps back smaller than this are that skew.
+SKEW_CYCLES = 1 << 16
+
+
+def unwrap(records):
+    """Extends the 32-bit cycle counter across wraps inside the window.
+
+    The counter only shows the gap between two records modulo 2^32. A small step back is preemption
+    skew, every other step is taken as the unsigned forward gap. Gaps of 2^32 cycles or more between
+    consecutive records (about 60 s at 72 MHz) can't be recovered and come out shortened by whole wraps.
+    """
+    now = None
+    previous = 0
+    for timestamp, *rest in records:
+        if now is None:
+            now = timestamp
+        else:
+            delta = (timestamp - previous) & 0xFFFFFFFF
+            if delta > (1 << 32) - SKEW_CYCLES:
+                delta -= 1 << 32
+            now += delta
+        previous = timestamp
+        yield (now, *rest)
+
+
+def describe(event, arg, data):
+    if event == 0x01:
+        return "submit %s" % name_of(OPERATIONS, arg), {"operation": name_of(OPERATIONS, arg), "bytes": data}
+    if event == 0x02:
+        direction = "read" if data & 0x8000 else "write"
+        return "START 0x%02x %s" % (arg, direction), {"address": "0x%02x" % arg, "nbytes": data & 0xFF, "dir": direction}
+    if event == 0x03:
+        return "isr %s" % name_of(ISR_FLAGS, data), {"flag": name_of(ISR_FLAGS, data)}
+    if event == 0x05:
+        return "NACK", {"state": name_of(STATES, arg)}
+    if event == 0x07:
+        return "callback %s" % name_of(CALLBACKS, arg), {}
+    if event == 0x08:
+        return "TIMEOUT", {"state": name_of(STATES, arg)}
+    return name_of(EVENTS, event), {}
+
+
+def convert(records, cpu_hz):
+    to_us = 1e6 / cpu_hz
+    out = []
+    open_state = {}
+    last_ts = 0.0
+
+    for timestamp, event, bus, arg, data in unwrap(records):
+        ts = timestamp * to_us
+        last_ts = ts
+        if event == 0x04:
+            # Close the span of the previous state on this bus and open the next one
+            if bus in open_state:
+                start, state = open_state.pop(bus)
+                out.append({"name": name_of(STATES, state), "cat": "state", "ph": "X",
+                            "ts": start, "dur": ts - start, "pid": 1, "tid": bus})
+            if arg != 0:
+                open_state[bus] = (ts, arg)
+            continue
+
+        name, args = describe(event, arg, data)
+        out.append({"name": name, "cat": name_of(EVENTS, event), "ph": "i", "s": "t",
+                    "ts": ts, "pid": 1, "tid": bus, "args": args})
+
+    for bus, (start, state) in open_state.items():
+        out.append({"name": name_of(STATES, state), "cat": "state", "ph": "X",
+                    "ts": start, "dur": last_ts - start, "pid": 1, "tid": bus})
+
+    buses = sorted({bus for _, _, bus, _, _ in records})
+    out.append({"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "I2C"}})
+    for bus in buses:
+        out.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": bus, "args": {"name": "I2C bus %d" % bus}})
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="raw memory dump of I2C_Trace_Ring")
+    parser.add_argument("--cpu-hz", type=float, required=True, help="frequency of the timestamp counter")
+    parser.add_argument("-o", "--output", help="output file, stdout if omitted")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        dump = f.read()
+
+    records, dropped = read_records(dump)
+    trace = {"traceEvents": convert(records, args.cpu_hz), "displayTimeUnit": "ns",
+             "otherData": {"events": len(records), "overwritten": dropped}}
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f, indent=1)
+    else:
+        json.dump(trace, sys.stdout, indent=1)
+    if dropped:
+        print("note: %d older events were overwritten" % dropped, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()